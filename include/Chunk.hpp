@@ -12,6 +12,7 @@ The (x,z) coordinates give the location of the point in 2D while the y coordinat
 
 // Standard libraries
 #include <vector>
+#include <memory>
 
 // OpenGL libraries
 #include <GL/glew.h>                            // OpenGL Library
@@ -23,37 +24,67 @@ The (x,z) coordinates give the location of the point in 2D while the y coordinat
 #include <SFML/Window.hpp>                      // Windowing library
 
 // Custom libraries
-#include "ColorMap.hpp"                         // Init the color buffer
+#include "ColorMap.hpp"                         // Init the 2D texture
+#include "GLHandle.hpp"                         // RAII OpenGL objects
+#include "ChunkIndexBuffer.hpp"                 // Shared element buffer
+#include "ChunkBatch.hpp"                       // Shared vertex buffers of the multi-draw
+
+// Number of tiles per chunk side of the coarse min/max height grid
+#define HEIGHT_TILES_PER_SIDE 8
 
 /**
  * @class Chunk
- * @brief describe a NxN chunk of vertices and colors for rendering
+ * @brief describe a NxN chunk of vertices and colors for rendering. Chunks are move-only: the height map and the
+ * OpenGL objects are never duplicated, and the OpenGL objects are only deleted by the chunk that owns them.
  */
 class Chunk {
 
     private:
 
         // Specific Attributes
-        double m_chunkSize;             // size of the chunk (in meters)
-        double m_resolution;            // distance between points (in meters)
-        unsigned int m_pointsPerSide;   // N = points per side
-        glm::vec2 m_chunkCoords;        // coordinates of the chunk in the chunk map (in chunks)
-        bool m_preparedToRender;        // flag to check if the chunk is prepared to render
-
-        // 3D rendering variables
-        GLuint vertexArrayObject;  // Vertex Array Object (VAO) for the chunk, contains vertices and colors VBOs and EBO
-        GLuint vertexBuffer;       // Vertex Buffer Object (VBO) for vertices
-        GLuint colorBuffer;        // Vertex Buffer Object (VBO) for colors 
-        GLuint elementBuffer;      // Element Buffer Object (EBO) for indices
-
-        // 2D Rendering variable
-        sf::Texture texture2D;     // Texture for the chunk
-        sf::Image image;           // Image for the texture
+        double m_chunkSize = 0;             // size of the chunk (in meters)
+        double m_resolution = 0;            // distance between points (in meters)
+        unsigned int m_pointsPerSide = 0;   // N = points per side
+        glm::vec2 m_chunkCoords;            // coordinates of the chunk in the chunk map (in chunks)
+        glm::vec3 m_origin = glm::vec3(0);  // position of the first point of the height map, at height 0 (in meters)
+        bool m_preparedToRender = false;    // flag to check if the chunk is prepared to render
+        glm::vec3 m_boundsMin = glm::vec3(0);   // Lowest corner of the bounding box of the height map (in meters)
+        glm::vec3 m_boundsMax = glm::vec3(0);   // Highest corner of the bounding box of the height map (in meters)
+
+        // Coarse min/max height grid: bounding boxes of square tiles of the height map, sharing their border points
+        std::vector<std::pair<glm::vec3, glm::vec3>> m_tileBounds;     // Lowest and highest corners of the tiles, row-major
+        unsigned int m_tileStep = 1;        // Number of quads per tile side
+        unsigned int m_tilesPerSide = 0;    // Number of tiles per chunk side
+
+        // Largest height difference between the height map and each level of detail (in meters)
+        std::vector<float> m_lodErrors;
+
+        // 3D rendering variables (created by prepareToRender on the OpenGL thread)
+        GLVertexArray vertexArrayObject;    // Vertex Array Object (VAO) for the chunk, contains the vertices VBO and the shared EBO
+        GLBuffer vertexBuffer;              // Vertex Buffer Object (VBO) for the vertex heights, x and z come from the vertex index
+        int m_batchSlot = -1;               // Slot of the vertices in the chunk batch, -1 if the chunk has its own buffers
+
+        // 2D Rendering variable (created by prepareToRender, on the heap so that sprites keep a stable pointer to it)
+        std::unique_ptr<sf::Texture> texture2D;     // Texture for the chunk
+
+        // Staging buffers, filled by the workers row by row and uploaded by prepareToRender on the OpenGL thread (the 3D
+        // colors come from the color map's lookup table in the fragment shader)
+        std::vector<sf::Uint8> m_pixels;            // RGBA pixels of the 2D texture
+        unsigned int m_rowsStaged = 0;              // Number of rows staged
+
+        // Stage every row if no worker did
+        void stageAll(ColorMap* cmapPointer);
+
+        // Create the 2D texture from the staged pixels
+        void createTexture();
+
+        // Get the heights of the skirt vertices, under the edge vertices at the chunk's lowest height
+        std::vector<float> skirtHeights() const;
 
     public:
 
-        // Chunk heightmap
-        std::vector<glm::vec3> heightMap;
+        // Chunk heightmap: height of the point (row, col) at row * N + col, at origin() + resolution * (row, 0, col)
+        std::vector<float> heightMap;
         
         ////////////////////////// METHODS //////////////////////////////////////
         
@@ -63,11 +94,50 @@ class Chunk {
         // Custom constructor
         Chunk(int64_t seed, double chunkSize, double resolution, glm::vec2 chunkCoords);
 
-        // Init buffers
-        void prepareToRender(ColorMap* cmapPointer);
+        // Move only
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+        Chunk(Chunk&&) = default;
+        Chunk& operator=(Chunk&&) = default;
+
+        // Allocate the staging buffers
+        void beginStaging();
+
+        // Fill in the pixels of one row of the height map into the staging buffers
+        void stageRow(unsigned int row, const ColorMap& cmap);
+
+        // Empty the bounding box, before the rows are added to it
+        void resetBounds();
+
+        // Grow the bounding box and the boxes of the tiles to contain one row of the height map
+        void boundRow(unsigned int row);
+
+        // Compute the bounding box of the whole height map
+        void computeBounds();
+
+        // Compute the height error of each level of detail
+        void computeLodErrors();
 
-        // Render the 3D chunk
-        void renderChunk(GLuint* shaderProgram);
+        // Check whether every row is staged
+        bool staged() const { return m_pointsPerSide > 0 && m_rowsStaged == m_pointsPerSide; }
+
+        // Init buffers, with the element buffer shared by the chunks of this size
+        void prepareToRender(ColorMap* cmapPointer, const ChunkIndexBuffer& indexBuffer);
+
+        // Init the texture and upload the vertices to a slot of the chunk batch instead of buffers of its own
+        void prepareToRender(ColorMap* cmapPointer, ChunkBatch& batch, unsigned int slot);
+
+        // Init the texture only, for the 2D view (no vertex buffer)
+        void prepareTexture(ColorMap* cmapPointer);
+
+        // Render the 3D chunk at a level of detail (the shader program and the primitive restart are set by the caller)
+        void renderChunk(const ChunkIndexBuffer& indexBuffer, unsigned int level, GLint originLocation);
+
+        // Free the buffers and the texture (on the OpenGL thread), prepareToRender uploads them again from the staging buffers
+        void releaseRenderData();
+
+        // Get the memory used by the chunk on the CPU and, once prepared to render, on the GPU (in bytes)
+        size_t memoryBytes() const;
         
         ////////////////////////// GETTERS AND SETTERS //////////////////////////
 
@@ -83,12 +153,42 @@ class Chunk {
         // Get the chunk coordinates
         glm::vec2 chunkCoords() { return m_chunkCoords; }
 
+        // Set the position of the first point of the height map (y is ignored)
+        void setOrigin(glm::vec3 origin) { m_origin = glm::vec3(origin.x, 0, origin.z); }
+
+        // Get the position of the first point of the height map, at height 0
+        const glm::vec3& origin() const { return m_origin; }
+
+        // Get the position of a point of the height map
+        glm::vec3 point(unsigned int row, unsigned int col) const {
+            return glm::vec3(m_origin.x + m_resolution * row, heightMap[static_cast<size_t>(row) * m_pointsPerSide + col],
+                             m_origin.z + m_resolution * col);
+        }
+
+        // Get the lowest corner of the bounding box
+        const glm::vec3& boundsMin() const { return m_boundsMin; }
+
+        // Get the highest corner of the bounding box
+        const glm::vec3& boundsMax() const { return m_boundsMax; }
+
+        // Get the number of levels of detail with a known height error
+        unsigned int lodLevels() const { return static_cast<unsigned int>(m_lodErrors.size()); }
+
+        // Get the largest height difference between the height map and a level of detail (in meters)
+        float lodError(unsigned int level) const { return m_lodErrors[level]; }
+
+        // Get the bounding boxes of the tiles of the coarse height grid
+        const std::vector<std::pair<glm::vec3, glm::vec3>>& tileBounds() const { return m_tileBounds; }
+
         // Get the 2D texture
-        sf::Texture* getTexture() { return &(this->texture2D); }
+        sf::Texture* getTexture() { return this->texture2D.get(); }
 
         // Get the flag preparedToRender
         bool preparedToRender() { return m_preparedToRender; }
 
-        // Destructor : destroys the buffers
-        ~Chunk();
+        // Get the slot of the chunk in the chunk batch (-1 if the chunk has its own buffers)
+        int batchSlot() const { return m_batchSlot; }
+
+        // Destructor : the buffers and the texture are destroyed by their owners
+        ~Chunk() = default;
 };
\ No newline at end of file
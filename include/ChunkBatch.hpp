@@ -0,0 +1,80 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Batch class header file. The Chunk Batch stores the vertex heights of all the live chunks in one vertex buffer,
+one fixed-size slot per chunk, behind a single vertex array with the shared element buffer. All the chunks are then
+drawn with one glMultiDrawElementsBaseVertex call per frame, the base vertex selecting the slot. The origin of the
+chunk in each slot is in a buffer texture, where the shader finds it from the vertex index.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+
+// OpenGL
+#include <GL/glew.h>                            // OpenGL Library
+#include <glm/glm.hpp>                          // OpenGL Mathematics
+
+// Project headers
+#include "GLHandle.hpp"                         // RAII OpenGL objects
+#include "ChunkIndexBuffer.hpp"                 // Shared element buffer
+
+/**
+ * @class ChunkBatch
+ * @brief Vertex storage and draw list of the chunks drawn with one multi-draw call. OpenGL thread only.
+ */
+class ChunkBatch {
+
+    private:
+
+        // OpenGL objects
+        GLVertexArray m_vertexArray;            // Vertex Array Object (VAO) with the batch buffers and the shared EBO
+        GLBuffer m_vertexBuffer;                // Vertex heights of all the slots
+        GLBuffer m_originBuffer;                // Origin of the chunk in each slot (x, 0, z, 0)
+        GLTexture m_originTexture;              // Buffer texture (RGBA32F) over the origins
+
+        // Layout
+        unsigned int m_slots = 0;               // Number of chunk slots
+        GLint m_slotVertices = 0;               // Number of vertices per slot (grid and skirts)
+        const ChunkIndexBuffer* m_indexBuffer = nullptr;    // Shared element buffer, with the levels of detail
+
+        // Draw list of the frame
+        std::vector<GLsizei> m_counts;          // Number of indices of each draw
+        std::vector<const void*> m_offsets;     // Offset of the first index of each draw (its level of detail)
+        std::vector<GLint> m_baseVertices;      // First vertex of each draw (slot * vertices per slot)
+
+    public:
+
+        // Check whether the driver supports multi-draw with a base vertex (OpenGL 3.2)
+        static bool supported();
+
+        // Allocate the buffers for some number of chunks of a size, with the shared element buffer
+        void create(unsigned int slots, unsigned int pointsPerSide, const ChunkIndexBuffer& indexBuffer);
+
+        // Check whether the buffers are allocated
+        bool created() const { return static_cast<bool>(m_vertexArray); }
+
+        // Upload the vertex heights (grid and skirts) and origin of a chunk to a slot
+        void upload(unsigned int slot, const std::vector<float>& heights, const std::vector<float>& skirt, const glm::vec3& origin);
+
+        // Empty the draw list
+        void clear();
+
+        // Add the chunk in a slot to the draw list, at a level of detail
+        void add(unsigned int slot, unsigned int level);
+
+        // Draw the chunks of the draw list in one call, with the origins bound to a texture unit, returns the number of chunks drawn
+        size_t draw(GLenum originUnit);
+
+        // Get the number of vertices per slot
+        GLint slotVertices() const { return m_slotVertices; }
+
+        // Get the size of the vertex and origin buffers (in bytes)
+        size_t bytes() const {
+            return static_cast<size_t>(m_slots) * (m_slotVertices * sizeof(float) + sizeof(glm::vec4));
+        }
+};
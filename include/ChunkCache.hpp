@@ -0,0 +1,116 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Cache class header file. The Chunk Cache keeps the chunks that recently left the view distance in memory, up to
+a byte budget, so that a user oscillating around a chunk border does not pay for generating and uploading them again.
+The least recently dropped chunks are evicted first.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+
+// SFML
+#include <SFML/Graphics.hpp>      // Simple and Fast Multimedia Library
+
+// Project headers
+#include "Chunk.hpp"
+
+/**
+ * @brief A loaded chunk and its sprite in the 2D map view (the sprite is set once the chunk is prepared to render)
+ */
+struct ChunkEntry {
+    Chunk chunk;            // 3D chunk
+    sf::Sprite sprite;      // 2D map view sprite
+};
+
+/**
+ * @brief Options of the chunk caches
+ */
+struct ChunkCacheOptions {
+    std::string directory = "chunk_cache";  // Directory of the persistent chunk store, empty to disable it
+    size_t memoryBytes = 64 << 20;          // Memory budget of the recently dropped chunks
+    bool keepGLBuffers = false;             // Keep the OpenGL buffers and texture of the recently dropped chunks
+};
+
+/**
+ * @brief Chunk cache counters
+ */
+struct ChunkCacheStats {
+    uint64_t hits = 0;          // Chunks taken back from the cache
+    uint64_t misses = 0;        // Chunks looked up but not in the cache
+    uint64_t evictions = 0;     // Chunks evicted to stay under the budget
+    size_t bytes = 0;           // Memory used by the cached chunks
+    size_t count = 0;           // Number of cached chunks
+};
+
+/**
+ * @class ChunkCache
+ * @brief LRU cache of dropped chunks. Only used by the render thread, it is not thread safe.
+ */
+class ChunkCache {
+
+    public:
+
+        typedef std::pair<int, int> Coords;                      // Chunk coordinates (in chunks)
+        typedef std::pair<Coords, ChunkEntry> Evicted;           // Chunk evicted from the cache
+
+    private:
+
+        // Hash of chunk coordinates
+        struct CoordsHash {
+            size_t operator()(const Coords& c) const {
+                return std::hash<uint64_t>()(static_cast<uint64_t>(static_cast<uint32_t>(c.first)) << 32 | static_cast<uint32_t>(c.second));
+            }
+        };
+
+        // A cached chunk and its memory footprint
+        struct Item {
+            Coords coords;
+            ChunkEntry entry;
+            size_t bytes;
+        };
+
+        ///////////////////////////// MEMBER VARIABLES /////////////////////////////
+        size_t m_budget;                                                        // Memory budget (in bytes)
+        size_t m_bytes;                                                         // Memory used (in bytes)
+        std::list<Item> m_items;                                                // Most recently dropped first
+        std::unordered_map<Coords, std::list<Item>::iterator, CoordsHash> m_index;   // Items by coordinates
+        ChunkCacheStats m_stats;                                                // Counters
+
+    public:
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Constructor
+        explicit ChunkCache(size_t budgetBytes);
+
+        // Add a dropped chunk, the chunks evicted to stay under the budget are appended to evicted
+        void insert(Coords coords, ChunkEntry&& entry, std::vector<Evicted>& evicted);
+
+        // Take a chunk back out of the cache, returns false if it is not cached
+        bool take(Coords coords, ChunkEntry& entry);
+
+        // Check whether a chunk is cached, without counting a hit or a miss
+        bool contains(Coords coords) const { return m_index.count(coords) > 0; }
+
+        // Call f(coords, entry) for each cached chunk
+        template <class F>
+        void forEach(F f) {
+            for (auto& item : m_items) {
+                f(item.coords, item.entry);
+            }
+        }
+
+        // Get the cache counters
+        ChunkCacheStats stats() const;
+};
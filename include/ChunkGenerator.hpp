@@ -0,0 +1,61 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Generator class header file. The Chunk Generator fills the height map of a chunk from the typed terrain
+parameters, and stages its 2D texture pixels in the same sweep. It is the generation stage used
+by the Chunk Manager's worker threads.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <utility>
+#include <functional>
+
+// Project headers
+#include "Perlin.hpp"
+#include "Chunk.hpp"
+#include "TerrainParams.hpp"
+#include "ColorMap.hpp"
+
+/**
+ * @class ChunkGenerator
+ */
+class ChunkGenerator {
+
+    private:
+
+        ///////////////////////////// MEMBER VARIABLES /////////////////////////////
+        TerrainParams m_params;         // Terrain parameters, validated by the caller
+        GradientNoise m_gradientNoise;  // Perlin noise generator
+        NoiseRowKernel m_rowKernel;     // Batched noise kernel specialized on the noise mode, octaves and precision
+        const ColorMap* m_cmap;         // Color map of the staged rows, nullptr to only fill in the heights
+
+    public:
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Constructor
+        ChunkGenerator(const TerrainParams& params, const ColorMap* cmap = nullptr);
+
+        // Set the position of a chunk's first height map point, the x and z coordinates of the others follow from it
+        void setOrigin(std::pair<int, int> chunkCoords, Chunk& chunk) const;
+
+        // Fill in a chunk's height map and stage it, returns the number of rows generated (less than N if cancelled)
+        int generate(std::pair<int, int> chunkCoords, Chunk& chunk, const std::function<bool()>& cancelled = nullptr);
+
+        // Sample the heights of a regular grid of points, x-major (heights[row * cols + col] at x0 + row * spacing, z0 + col * spacing)
+        void sampleGrid(double x0, double z0, double spacing, int rows, int cols, float* heights);
+
+        // Compute the bounding box and the level of detail errors, and stage the pixels of a chunk whose height map is already filled in
+        void stage(Chunk& chunk) const;
+
+        // Get the terrain parameters
+        const TerrainParams& params() const { return m_params; }
+
+        // Get the noise generator
+        const GradientNoise& gradientNoise() const { return m_gradientNoise; }
+};
@@ -0,0 +1,80 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Index Buffer class header file. One element buffer holds the cache-optimized triangle strips of a chunk size, at
+each level of detail with its skirts, and is bound to the vertex arrays of all the chunks of that size, instead of each
+chunk uploading its own copy.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+
+// Project headers
+#include "GLHandle.hpp"                         // RAII OpenGL objects
+#include "ChunkIndices.hpp"                     // Cache-optimized index order
+
+/**
+ * @class ChunkIndexBuffer
+ * @brief Shared element buffer of the chunks with the same number of points per side. Created and destroyed on the
+ * OpenGL thread; the vertex arrays that use it must not outlive it.
+ */
+class ChunkIndexBuffer {
+
+    private:
+
+        GLBuffer m_buffer;              // Element Buffer Object (EBO)
+        GLsizei m_count = 0;            // Number of indices of all the levels
+        std::vector<GLsizei> m_levelCounts;         // Number of indices of each level of detail
+        std::vector<size_t> m_levelOffsets;         // Offset of the first index of each level of detail (in indices)
+        std::vector<size_t> m_levelTriangles;       // Number of triangles of each level of detail
+
+    public:
+
+        // Build the indices of every level of detail for a chunk size and upload them
+        void create(unsigned int pointsPerSide) {
+            std::vector<unsigned int> indices;
+            unsigned int levels = chunkLodLevels(pointsPerSide);
+            for (unsigned int level = 0; level < levels; level++) {
+                // Strips of the level, then its skirts
+                std::vector<unsigned int> grid = bandedStripIndices(pointsPerSide, 0, 1u << level);
+                std::vector<unsigned int> skirts = skirtStripIndices(pointsPerSide, 1u << level);
+                m_levelOffsets.push_back(indices.size());
+                indices.insert(indices.end(), grid.begin(), grid.end());
+                indices.push_back(CHUNK_RESTART_INDEX);
+                indices.insert(indices.end(), skirts.begin(), skirts.end());
+                m_levelCounts.push_back(static_cast<GLsizei>(indices.size() - m_levelOffsets.back()));
+                m_levelTriangles.push_back(stripTriangleCount(grid) + stripTriangleCount(skirts));
+            }
+            m_count = static_cast<GLsizei>(indices.size());
+            glBindVertexArray(0);       // The element buffer binding is vertex array state, do not change the bound one
+            m_buffer.create();
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer.get());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }
+
+        // Get the buffer name
+        GLuint get() const { return m_buffer.get(); }
+
+        // Get the number of levels of detail
+        unsigned int levels() const { return static_cast<unsigned int>(m_levelCounts.size()); }
+
+        // Get the number of indices of a level of detail, drawn as one GL_TRIANGLE_STRIP
+        GLsizei count(unsigned int level) const { return m_levelCounts[level]; }
+
+        // Get the offset of the first index of a level of detail, as passed to glDrawElements
+        const void* offset(unsigned int level) const {
+            return reinterpret_cast<const void*>(m_levelOffsets[level] * sizeof(unsigned int));
+        }
+
+        // Get the number of triangles of a level of detail
+        size_t triangles(unsigned int level) const { return m_levelTriangles[level]; }
+
+        // Get the size of the buffer (in bytes)
+        size_t bytes() const { return static_cast<size_t>(m_count) * sizeof(unsigned int); }
+};
@@ -0,0 +1,50 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk index generation header file. Every chunk with the same number of points per side has the same triangle strip
+topology, so its indices are built once, on the CPU, and shared. The strips run over column bands narrow enough for
+the vertices shared by two consecutive strips to still be in the GPU's post-transform vertex cache, and are separated
+by the primitive restart index so that a chunk is drawn in one call. Coarser levels of detail sample every 2^l-th
+row and column of the same vertices, and skirts hanging under the chunk edges hide the cracks between neighbouring
+chunks drawn at different levels.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+#include <cstddef>
+
+// Number of entries assumed for the post-transform vertex cache (FIFO); the bands are sized to fit in it
+#define VERTEX_CACHE_SIZE 24
+
+// Index that ends a triangle strip and starts the next one (GL_PRIMITIVE_RESTART)
+#define CHUNK_RESTART_INDEX 0xFFFFFFFFu
+
+// Maximum number of levels of detail of a chunk (strides 1, 2, 4, ...)
+#define CHUNK_MAX_LOD_LEVELS 6
+
+// Get the number of vertices of a chunk: the N^2 grid, then the 4N skirt vertices under its edges
+size_t chunkVertexCount(unsigned int pointsPerSide);
+
+// Get the number of levels of detail of a chunk size, the coarsest one still has 2 quads per side
+unsigned int chunkLodLevels(unsigned int pointsPerSide);
+
+// Get the rows (or columns) sampled by a level of detail: every stride-th one, and the last one
+std::vector<unsigned int> lodSamples(unsigned int pointsPerSide, unsigned int stride);
+
+// Build the triangle strip indices of a chunk in column bands of bandQuads quads (0 to size the bands for the cache),
+// over every stride-th row and column
+std::vector<unsigned int> bandedStripIndices(unsigned int pointsPerSide, unsigned int bandQuads = 0, unsigned int stride = 1);
+
+// Build the triangle strip indices of the skirts of a chunk, over every stride-th vertex of its edges
+std::vector<unsigned int> skirtStripIndices(unsigned int pointsPerSide, unsigned int stride = 1);
+
+// Count the vertices transformed to draw triangle strips with a FIFO vertex cache of cacheSize entries
+size_t stripVertexCacheMisses(const std::vector<unsigned int>& indices, unsigned int cacheSize);
+
+// Count the non-degenerate triangles of triangle strips separated by the restart index
+size_t stripTriangleCount(const std::vector<unsigned int>& indices);
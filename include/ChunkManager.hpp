@@ -11,11 +11,12 @@ deleted, and rendered. It also handles the 2D map view.
 #pragma once
 
 // Standard libraries
-#include <map>                    
 #include <vector>                 
-#include <thread>
-#include <mutex>
-#include <queue>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <set>
+#include <map>
 
 // OpenGL
 #include <GL/glew.h>              // OpenGL Library
@@ -24,15 +25,88 @@ deleted, and rendered. It also handles the 2D map view.
 // SFML
 #include <SFML/Graphics.hpp>      // Simple and Fast Multimedia Library
 
-// Include boost
-#include <boost/program_options.hpp>
-
 // Project headers
-#include "Perlin.hpp"
 #include "Chunk.hpp"
-#include "ColorMap.hpp"           // Init the color buffer
+#include "ChunkGenerator.hpp"     // Fill in the chunks' height maps
+#include "TerrainParams.hpp"
+#include "ThreadPool.hpp"         // Worker threads that generate the chunks
+#include "ToroidalGrid.hpp"       // Storage of the live chunks
+#include "ChunkStore.hpp"         // Persistent storage of the dropped chunks
+#include "ChunkCache.hpp"         // In-memory retention of the recently dropped chunks
+#include "MPSCQueue.hpp"          // Hand-off of the finished chunks to the render thread
+#include "ColorMap.hpp"           // Color the 2D textures and the 3D chunks
+#include "ChunkIndexBuffer.hpp"   // Element buffers shared by the chunks
+#include "ChunkBatch.hpp"         // Vertex buffers shared by the chunks for the multi-draw
+#include "Frustum.hpp"            // Culling of the chunks out of the view
+#include "HorizonCuller.hpp"      // Culling of the chunks hidden behind nearer terrain
+
+/**
+ * @brief Chunk generation counters, to measure the work saved by cancelling the chunks that went out of range
+ */
+struct GenerationStats {
+    uint64_t generated = 0;         // Chunks fully generated
+    uint64_t loaded = 0;            // Chunks loaded from the chunk store instead of generated
+    uint64_t cancelledQueued = 0;   // Jobs dropped before they started
+    uint64_t cancelledRunning = 0;  // Jobs stopped between two rows
+    uint64_t discarded = 0;         // Chunks generated but out of range when they were done
+    uint64_t rowsSaved = 0;         // Height map rows that were not generated thanks to the cancellations
+    uint64_t prefetched = 0;        // Chunks made ready ahead of the camera and moved to the chunk cache
+};
+
+/**
+ * @brief Chunk streaming counters, to measure the churn of the chunk grid when the camera moves around a chunk border
+ */
+struct StreamingStats {
+    uint64_t centerMoves = 0;       // Changes of the center chunk (one per axis)
+    uint64_t reversals = 0;         // Center changes that undid the previous one along the same axis
+    uint64_t loads = 0;             // Chunks added to the chunk grid
+    uint64_t unloads = 0;           // Chunks removed from the chunk grid
+    uint64_t reloads = 0;           // Chunks added back to the chunk grid after they were unloaded nearby (churn)
+};
+
+/**
+ * @brief Chunk upload counters, to measure the frame time spent preparing the new chunks to render
+ */
+struct UploadStats {
+    uint64_t uploads = 0;           // Chunks prepared to render (buffers and texture uploaded)
+    uint64_t frames = 0;            // Frames that uploaded at least one chunk
+    uint64_t overBudget = 0;        // Frames whose uploads took longer than the budget
+    double totalMs = 0;             // Time spent uploading (in milliseconds)
+    double maxFrameMs = 0;          // Longest upload time of a single frame (in milliseconds)
+    size_t maxBacklog = 0;          // Largest number of chunks waiting for their upload at the start of a frame
+};
+
+/**
+ * @brief Chunk draw counters, to measure the draw calls issued per frame
+ */
+struct RenderStats {
+    uint64_t frames = 0;            // Frames rendered
+    uint64_t drawCalls = 0;         // Draw calls issued for the chunks
+    uint64_t chunksDrawn = 0;       // Chunks drawn
+    uint64_t culled = 0;            // Chunks prepared to render but skipped, their bounding box being out of the view frustum
+    uint64_t occluded = 0;          // Chunks in the view frustum but skipped, being hidden behind nearer terrain
+    uint64_t triangles = 0;         // Triangles drawn, at the level of detail of each chunk
+    uint64_t coarseChunks = 0;      // Chunks drawn at a coarser level of detail than the full resolution
+};
+
+/**
+ * @brief Options of the 3D rendering of the chunks
+ */
+struct RenderOptions {
+    bool multiDraw = false;         // Draw all the chunks with one glMultiDrawElementsBaseVertex call instead of one call per chunk
+    bool occlusion = true;          // Skip the chunks hidden behind nearer terrain (horizon occlusion culling)
+    float lodPixels = 2.0f;         // Largest screen-space height error of a chunk's level of detail (in pixels), 0 for the full resolution
+    bool textureOnly = false;       // Only upload the 2D textures of the chunks (the 3D view is drawn by the clipmap)
+};
 
-namespace po = boost::program_options;
+/**
+ * @brief Options of the chunk streaming around the camera
+ */
+struct StreamingOptions {
+    float prefetchTime = 1.0f;      // Look-ahead time of the prefetch along the camera velocity (in seconds), 0 to disable
+    int unloadMargin = 1;           // Chunks between the load radius (view distance) and the unload radius
+    float uploadBudgetMs = 4.0f;    // Time per frame spent preparing new chunks to render (in milliseconds), 0 for no limit
+};
 
 /**
  * @class ChunkManager
@@ -45,43 +119,164 @@ class ChunkManager {
         glm::vec3 m_pos;            // Player's position
         glm::vec3 m_prevPos;        // Player's previous position
         glm::vec3 m_center;         // Center of the chunk map
+        std::pair<int, int> m_centerChunk;  // Coordinates of the center chunk (in chunks)
         float m_chunkSize;          // Size of a chunk (in meters)
         float m_resolution;         // Resolution of the chunks (in meters)
-        int16_t m_viewDist;         // View distance (in chunks) from the user's position
+        int m_viewDist;             // View distance (in chunks) from the user's position, chunks inside are loaded
+        int m_unloadDist;           // Unload distance (in chunks) from the user's position, chunks outside are unloaded
         int64_t m_seed;             // Seed for the Perlin noise
+        float m_prefetchTime;       // Look-ahead time of the prefetch (in seconds)
+        double m_prefetchPenalty;   // Priority offset that puts the prefetched chunks behind the visible ones
+        std::pair<int, int> m_prefetchChunk;    // Center chunk predicted at the look-ahead time (in chunks)
+        std::pair<int, int> m_lastStep;         // Direction of the last center change along each axis (-1, 0 or 1)
+        float m_uploadBudgetMs;     // Time per frame spent preparing new chunks to render (in milliseconds)
+        double m_uploadCostMs;      // Running average of the time to prepare one chunk (in milliseconds)
+        UploadStats m_uploadStats;  // Chunk upload counters (render thread only)
+        std::vector<std::pair<float, std::pair<int, int>>> m_uploadQueue;   // Chunks waiting for their upload, by squared distance
+        bool m_multiDraw;           // Whether the chunks are drawn with one multi-draw call
+        bool m_textureOnly;         // Whether the chunks only get their 2D texture, without any 3D buffer
+        RenderStats m_renderStats;  // Chunk draw counters (render thread only)
+        std::vector<std::pair<float, ChunkEntry*>> m_drawQueue;     // Chunks in the view frustum, by squared distance
+        bool m_occlusion;           // Whether the chunks hidden behind nearer terrain are skipped
+        float m_lodPixels;          // Largest screen-space height error of a chunk's level of detail (in pixels)
+        HorizonCuller m_horizon;    // Occlusion horizon of the frame
+        std::vector<std::pair<float, std::pair<glm::vec3, glm::vec3>>> m_occluders;  // Height tiles as drawn, by farthest distance
+        std::vector<std::pair<float, size_t>> m_occludees;          // Draw queue chunks, by nearest distance
 
         // External objects
-        GradientNoise gradientNoise;    // Perlin noise generator
+        ChunkGenerator m_generator;     // Chunk height map generator
         ColorMap* m_cmapPointer;        // Pointer to the color map object
-        po::variables_map m_args;       // Command line arguments used by the noise generator
 
         // Multithreading
-        std::vector<std::thread> threadVector;          // Vector of threads that will be used to populate chunks
-        std::queue<std::pair<int, int>> deletionQueue;  // Queue of chunks that need to be deleted
-        std::mutex m_mut;                               // Mutex for the deletion queue
+        std::atomic<int> m_wantedCenterX;               // Center chunk seen by the workers (x, in chunks)
+        std::atomic<int> m_wantedCenterZ;               // Center chunk seen by the workers (z, in chunks)
+        std::atomic<int> m_prefetchCenterX;             // Predicted center chunk seen by the workers (x, in chunks)
+        std::atomic<int> m_prefetchCenterZ;             // Predicted center chunk seen by the workers (z, in chunks)
+
+        // Chunk generation counters, updated by the workers
+        struct {
+            std::atomic<uint64_t> generated{0};
+            std::atomic<uint64_t> loaded{0};
+            std::atomic<uint64_t> cancelledQueued{0};
+            std::atomic<uint64_t> cancelledRunning{0};
+            std::atomic<uint64_t> discarded{0};
+            std::atomic<uint64_t> rowsSaved{0};
+            std::atomic<uint64_t> prefetched{0};
+        } m_stats;
+
+        // A finished job: the chunk, or a job the worker cancelled
+        struct Completion {
+            std::pair<int, int> coords;     // Chunk coordinates (in chunks)
+            bool cancelled = false;         // Whether the job was cancelled, the chunk is empty then
+            Chunk chunk;                    // Chunk with its height map filled in
+        };
+
+        // Finished jobs, pushed by the workers and drained by the render thread, which owns everything below
+        MPSCQueue<Completion> m_completed;
+
+        // Chunk streaming counters
+        StreamingStats m_churn;
 
-        // 2D map view : map of chunk sprites with 2D grid locations (x, z) counted in chunks
-        std::map<std::pair<int, int>, sf::Sprite> chunkSprites;
+        // Chunks with a queued or running job, so that each chunk is generated once
+        std::set<std::pair<int, int>> m_scheduled;
+
+        // Chunks unloaded near the camera, to count the ones loaded again
+        std::set<std::pair<int, int>> m_unloaded;
+
+        // Element buffers shared by the chunks, by number of points per side. Declared before the chunks that use them.
+        std::map<unsigned int, ChunkIndexBuffer> m_indexBuffers;
+
+        // Vertex buffers of the multi-draw, one slot per chunk grid slot (created on first use if enabled)
+        ChunkBatch m_batch;
+
+        // Loaded chunks and their 2D map view sprites, in a (2 * unload distance + 1)^2 grid indexed by chunk coordinates
+        ToroidalGrid<ChunkEntry> m_chunkGrid;
+
+        // Recently dropped chunks, and whether they keep their OpenGL buffers (only used by the render thread)
+        ChunkCache m_cache;
+        bool m_keepGLBuffers;
+
+        // Persistent chunk store, nullptr if disabled
+        std::unique_ptr<ChunkStore> m_store;
+
+        // Chunk generation workers. Declared last so that they are stopped before the members they use are destroyed.
+        ThreadPool m_pool;
 
         
     public:
 
-        // Map of chunks : each loaded chunk is stored and mapped to a 2D grid location (x, z) counted in chunks
-        std::map<std::pair<int, int>, Chunk> chunkMap;
-
         ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
 
         // Constructor
-        ChunkManager(ColorMap* cmapPointer, po::variables_map args);
+        ChunkManager(ColorMap* cmapPointer, const TerrainParams& params, const ChunkCacheOptions& cacheOptions,
+                     const StreamingOptions& streamingOptions = StreamingOptions(),
+                     const RenderOptions& renderOptions = RenderOptions());
 
         // Update the chunk map based on the player's position (creation and deletion of chunks)
-        void update(glm::vec3 pos);
+        void update(glm::vec3 pos, glm::vec3 velocity = glm::vec3(0, 0, 0));
+
+        // Queue the chunks around the position the camera will reach within the look-ahead time
+        void prefetch(glm::vec3 velocity);
 
-        // Fill in a chunk's height values
+        // Fill in a chunk's height values and hand it over to the render thread
         void populateChunk(std::pair<int, int> currentPair);
 
-        // Render chunks in 3D
-        void renderChunks(GLuint* shaderProgramPointer);
+        // Queue the heights of a chunk to be written to the chunk store
+        void saveChunk(std::pair<int, int> currentPair, Chunk& chunk);
+
+        // Move a chunk that left the view distance to the chunk cache
+        void retainChunk(std::pair<int, int> currentPair, ChunkEntry&& entry);
+
+        // Get the chunk cache counters
+        ChunkCacheStats cacheStats() const { return m_cache.stats(); }
+
+        // Queue the generation of a chunk, nearest chunks first and visible chunks before prefetched ones
+        void requestChunk(std::pair<int, int> currentPair);
+
+        // Check whether a chunk is in the view distance, the chunks outside are queued behind the visible ones
+        bool isWanted(std::pair<int, int> currentPair) const;
+
+        // Check whether a chunk is in the unload distance, used to keep the chunks near a border the camera strafes across
+        bool isKept(std::pair<int, int> currentPair) const;
+
+        // Put a chunk in the chunk grid and count the load
+        void loadChunk(std::pair<int, int> currentPair, ChunkEntry&& entry);
+
+        // Check whether a chunk is in the view distance of the predicted center
+        bool isPrefetched(std::pair<int, int> currentPair) const;
+
+        // Check whether a chunk is kept or prefetched, the jobs of the other chunks are cancelled
+        bool isNeeded(std::pair<int, int> currentPair) const;
+
+        // Move the chunks finished by the workers to the chunk grid or to the chunk cache
+        void collectChunks();
+
+        // Get the chunk generation counters
+        GenerationStats generationStats() const;
+
+        // Get the chunk streaming counters
+        StreamingStats streamingStats() const { return m_churn; }
+
+        // Get the chunk upload counters
+        UploadStats uploadStats() const { return m_uploadStats; }
+
+        // Get the chunk draw counters
+        RenderStats renderStats() const { return m_renderStats; }
+
+        // Prepare the nearest chunks waiting for their upload, within the per-frame budget
+        void uploadChunks();
+
+        // Get the element buffer shared by the chunks with some number of points per side, created on first use
+        const ChunkIndexBuffer& indexBuffer(unsigned int pointsPerSide);
+
+        // Remove the chunks hidden behind nearer terrain from the draw queue, with the levels of detail of the frame
+        void cullOccluded(const glm::mat4& mvp, glm::vec2 viewport);
+
+        // Get the coarsest level of detail of a chunk whose height error stays under the screen-space error
+        unsigned int lodLevel(const Chunk& chunk, const glm::mat4& mvp, glm::vec2 viewport) const;
+
+        // Render the chunks in the view frustum of a Model View Projection matrix in 3D, nearest first (nothing in texture only mode)
+        void renderChunks(GLuint* shaderProgramPointer, const glm::mat4& mvp, glm::vec2 viewport);
 
         // Draw the 2D map view
         void drawChunks(sf::RenderWindow* window);
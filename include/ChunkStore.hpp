@@ -0,0 +1,138 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Store class header file. The Chunk Store keeps the height data of chunks on disk, so that chunks dropped by the
+Chunk Manager are reloaded instead of generated again when the user comes back, in the same session or in a later one.
+Heights are appended to a data file. A memory-mapped index (open addressing hash table) maps the chunk coordinates and
+the hash of the terrain parameters to their position in the data file. Writes are done behind by a dedicated thread.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <fstream>
+#include <utility>
+#include <cstdint>
+
+// Boost memory-mapped files
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/**
+ * @brief Chunk store counters
+ */
+struct ChunkStoreStats {
+    uint64_t hits = 0;          // Chunks loaded from the store
+    uint64_t misses = 0;        // Lookups of chunks that were not in the store
+    uint64_t writes = 0;        // Chunks written to the store
+    uint64_t entries = 0;       // Chunks in the store, for every terrain parameters
+};
+
+/**
+ * @class ChunkStore
+ */
+class ChunkStore {
+
+    private:
+
+        // Index file header
+        struct IndexHeader {
+            char magic[8];          // File signature
+            uint64_t capacity;      // Number of entries, a power of two
+            uint64_t count;         // Number of entries used
+        };
+
+        // Index entry: one chunk of one set of terrain parameters
+        struct IndexEntry {
+            uint64_t paramsHash;    // Hash of the terrain parameters
+            int32_t x;              // Chunk x coordinate (in chunks)
+            int32_t z;              // Chunk z coordinate (in chunks)
+            uint64_t offset;        // Offset of the heights in the data file (in bytes)
+            uint32_t count;         // Number of heights
+            uint32_t used;          // 1 if the entry is used
+        };
+
+        // Height data waiting to be written
+        struct PendingWrite {
+            std::pair<int, int> coords;
+            std::vector<float> heights;
+        };
+
+        ///////////////////////////// MEMBER VARIABLES /////////////////////////////
+        std::string m_indexPath;                            // Path of the index file
+        std::string m_dataPath;                             // Path of the data file
+        uint64_t m_paramsHash;                              // Hash of the terrain parameters of this session
+        boost::interprocess::file_mapping m_indexFile;      // Index file
+        boost::interprocess::mapped_region m_indexRegion;   // Mapping of the index file
+        std::fstream m_data;                                // Data file
+        std::mutex m_mut;                                   // Protects the index and the data file
+
+        // Write-behind
+        std::deque<PendingWrite> m_pending;     // Height data waiting to be written
+        std::mutex m_pendingMut;                // Protects m_pending and m_stop
+        std::condition_variable m_pendingCv;    // Wakes up the writer, or flush() callers
+        bool m_stop;                            // Set when the store is destroyed
+        bool m_writing;                         // Set while the writer writes a chunk
+        std::thread m_writer;                   // Writer thread
+
+        // Counters
+        std::atomic<uint64_t> m_hits;
+        std::atomic<uint64_t> m_misses;
+        std::atomic<uint64_t> m_writes;
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Map the index file, creating it with some capacity if it is missing or invalid
+        void openIndex(uint64_t capacity);
+
+        // Get the index header and entries
+        IndexHeader* header() const { return static_cast<IndexHeader*>(m_indexRegion.get_address()); }
+        IndexEntry* entries() const { return reinterpret_cast<IndexEntry*>(header() + 1); }
+
+        // Find the entry of a chunk, or the free entry where it would go
+        IndexEntry* findEntry(std::pair<int, int> coords) const;
+
+        // Double the capacity of the index
+        void growIndex();
+
+        // Write a chunk to the data file and the index
+        void write(const PendingWrite& pending);
+
+        // Main loop of the writer thread
+        void writerLoop();
+
+    public:
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Constructor : opens or creates the store in a directory, for the chunks of one set of terrain parameters
+        ChunkStore(const std::string& directory, uint64_t paramsHash);
+
+        // Load the heights of a chunk, returns false if the chunk is not in the store
+        bool load(std::pair<int, int> coords, std::vector<float>& heights);
+
+        // Check whether a chunk is in the store
+        bool contains(std::pair<int, int> coords);
+
+        // Queue the heights of a chunk to be written by the writer thread
+        void storeAsync(std::pair<int, int> coords, std::vector<float>&& heights);
+
+        // Wait until every queued chunk is written
+        void flush();
+
+        // Get the store counters
+        ChunkStoreStats stats();
+
+        // Destructor : writes the queued chunks and stops the writer thread
+        ~ChunkStore();
+};
@@ -0,0 +1,133 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Clipmap Renderer class header file. The geometry clipmap draws the terrain as nested square rings of one fixed grid
+mesh around the camera, each level twice as coarse as the one inside it. The heights of each level live in a layer of
+an array texture addressed toroidally, filled by the chunks' noise generator, so that when the camera moves only the
+newly exposed rows and columns are sampled and uploaded, a few rows per frame within a time budget. The grid positions come from gl_VertexID, the mesh itself is
+only an index buffer, and the heights are colored by the color map's lookup table.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// OpenGL
+#include <GL/glew.h>                            // OpenGL Library
+#include <glm/glm.hpp>                          // OpenGL Mathematics
+
+// Project headers
+#include "GLHandle.hpp"                         // RAII OpenGL objects
+#include "ChunkGenerator.hpp"                   // Height samples
+#include "TerrainParams.hpp"
+#include "ColorMap.hpp"
+
+/**
+ * @brief Options of the geometry clipmap renderer
+ */
+struct ClipmapOptions {
+    bool enabled = false;           // Draw the terrain with the clipmap instead of the chunks
+    unsigned int levels = 6;        // Number of nested levels, level l has a spacing of resolution * 2^l
+    unsigned int gridSize = 129;    // Points per side of a level's grid, 4k + 1 so that the rings nest
+    float updateBudgetMs = 4.0f;    // Time per frame spent sampling and uploading the levels (in milliseconds), 0 for no limit
+};
+
+/**
+ * @brief Clipmap counters, to measure the texels updated as the camera moves
+ */
+struct ClipmapStats {
+    uint64_t frames = 0;            // Frames rendered
+    uint64_t texelsUpdated = 0;     // Height samples computed and uploaded
+    uint64_t fullUpdates = 0;       // Levels refilled entirely (first frame, or a jump of more than a level's width)
+    uint64_t deferredFrames = 0;    // Frames that left rows to sample for the next frames (time budget spent)
+    uint64_t triangles = 0;         // Triangles drawn
+};
+
+/**
+ * @class ClipmapRenderer
+ * @brief Geometry clipmap terrain renderer. OpenGL thread only.
+ */
+class ClipmapRenderer {
+
+    private:
+
+        // Terrain sampling
+        ChunkGenerator m_generator;             // Noise generator of the chunks, used to sample the level grids
+        const ColorMap* m_cmap;                 // Color map, with the lookup table of the fragment shader
+        double m_resolution;                    // Spacing of the finest level (in meters)
+        unsigned int m_levels;                  // Number of levels
+        int m_size;                             // Points per side of a level's grid (m)
+        float m_updateBudgetMs;                 // Time per frame spent sampling and uploading the levels (in milliseconds)
+
+        // Shader program and its uniforms
+        GLuint m_program = 0;
+        GLint m_mvpLocation, m_originLocation, m_spacingLocation, m_levelLocation, m_sizeLocation, m_morphLocation;
+
+        // Mesh: one element buffer with the full grid (finest level) and the rings with their hole at each of its 4 offsets
+        GLVertexArray m_vertexArray;            // Vertex Array Object (VAO) without attributes, with the EBO
+        GLBuffer m_indexBuffer;                 // Element Buffer Object (EBO)
+        GLsizei m_counts[5];                    // Number of indices of the full grid and of each ring
+        size_t m_offsets[5];                    // Offset of the first index of the full grid and of each ring (in indices)
+        size_t m_triangles[5];                  // Number of triangles of the full grid and of each ring
+
+        // Level heights (R32F), one layer per level, texel (z mod m, x mod m) for the grid point (x, z)
+        GLTexture m_heights;
+
+        // Grid coordinates of the first point of each level (in points of the level), and whether they were set once
+        std::vector<glm::ivec2> m_origins;
+        bool m_placed = false;
+
+        // Regions of each level left to sample (x0, z0, rows, cols), filled row by row: a level is drawn once it has none
+        std::vector<std::deque<glm::ivec4>> m_pending;
+
+        // Staging of the samples of a region
+        std::vector<float> m_heightSamples;
+
+        // Counters
+        ClipmapStats m_stats;
+
+        // Wrap a grid coordinate into the level textures
+        int wrap(int coordinate) const { return ((coordinate % m_size) + m_size) % m_size; }
+
+        // Get the grid coordinates of the first point of a level centered on a position
+        glm::ivec2 levelOrigin(unsigned int level, glm::vec3 position) const;
+
+        // Queue a region of a level's grid to be sampled, or the whole level if its queue would cover it anyway
+        void queueRegion(unsigned int level, int x0, int z0, int rows, int cols);
+
+        // Sample and upload the queued rows, finest level first, within the time budget
+        void fillPending();
+
+        // Sample and upload a region of a level's grid, split where it wraps around the textures
+        void fillRegion(unsigned int level, int x0, int z0, int rows, int cols);
+
+        // Sample and upload a region of a level's grid that does not wrap around the textures
+        void fillTexels(unsigned int level, int x0, int z0, int rows, int cols);
+
+    public:
+
+        // Constructor : compiles the shader program, builds the mesh and allocates the level textures
+        ClipmapRenderer(const TerrainParams& params, const ColorMap* cmapPointer, const ClipmapOptions& options);
+
+        // Not copyable (owns the shader program)
+        ClipmapRenderer(const ClipmapRenderer&) = delete;
+        ClipmapRenderer& operator=(const ClipmapRenderer&) = delete;
+
+        // Center the levels on the camera position, uploading the newly exposed rows and columns within the time budget
+        void update(glm::vec3 position);
+
+        // Draw the filled levels with a Model View Projection matrix
+        void render(const glm::mat4& mvp);
+
+        // Get the clipmap counters
+        ClipmapStats stats() const { return m_stats; }
+
+        // Destructor : deletes the shader program and reports the counters
+        ~ClipmapRenderer();
+};
@@ -5,6 +5,7 @@ Last Date Modified: 11/27/2024
 
 Description:
 This file is the header file of the ColorMap class. It contains the methods to construct the class, and color the vertices of the terrain.
+The gradient is baked into a 1D texture (lookup table) sampled by height in the fragment shader, so that the vertices only carry their height.
 */
 
 #pragma once
@@ -15,6 +16,10 @@ This file is the header file of the ColorMap class. It contains the methods to c
 using namespace glm;
 
 #include <vector>
+#include <atomic>
+
+// OpenGL objects
+#include "GLHandle.hpp"
 
 /**
  * @author Thomas Etheve
@@ -33,6 +38,10 @@ enum class ColorMapType
 #define MAX_MOUNTAIN 0.3f     // multiplies maxAlt
 #define MAX_ALT 0.6f          // multiplies maxAlt
 
+// Lookup table texture
+#define COLORMAP_LUT_SIZE 1024      // Number of texels of the lookup table, over [minAlt, maxAlt]
+#define COLORMAP_TEXTURE_UNIT 1     // Texture unit of the lookup table in the shader programs
+
 /**
  * @author Thomas Etheve
  * @class ColorMap
@@ -41,13 +50,25 @@ enum class ColorMapType
 class ColorMap
 {
     private:
-        // Color map type
-        ColorMapType type;
+        // Color map type (read by the chunk workers, changed on the OpenGL thread)
+        std::atomic<ColorMapType> type;
 
         // Minimum and maximum value for color scale
         float minAlt;
         float maxAlt;
 
+        // Get the monochrome level of one altitude
+        glm::vec3 grayScaleColor(float y) const;
+
+        // Get the Earth Gist level of one altitude
+        glm::vec3 earthLevelColor(float y) const;
+
+        // Lookup table of the gradient (created by createTexture, on the OpenGL thread)
+        GLTexture lut;
+
+        // Fill in the lookup table texture with the gradient of the current type
+        void bakeTexture();
+
     public:
         // Default constructor
         ColorMap();
@@ -55,17 +76,30 @@ class ColorMap
         // Constructor
         ColorMap(ColorMapType type, float minAlt, float maxAlt);
 
-        // Get the color vector corresponding to the vertices vector
-        std::vector<glm::vec3> getColorVector(const std::vector<glm::vec3>& vertices);
+        // Not copyable (owns the lookup table texture)
+        ColorMap(const ColorMap&) = delete;
+        ColorMap& operator=(const ColorMap&) = delete;
+
+        // Get the color of one altitude (thread safe, used by the chunk workers)
+        glm::vec3 getColor(float y) const;
+
+        // Get the lookup table of the gradient, COLORMAP_LUT_SIZE colors from minAlt to maxAlt
+        std::vector<glm::vec3> getLookupTable() const;
+
+        // Create the lookup table texture (OpenGL thread)
+        void createTexture();
+
+        // Change the color map type, baking the lookup table texture again if it is created (OpenGL thread)
+        void setType(ColorMapType type);
 
-        // Get the color vector corresponding to monorchrome levels
-        void getGrayScale(const std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& colors);
+        // Get the color map type
+        ColorMapType getType() const { return this->type; }
 
-        // Get the color vector corresponding to monorchrome levels
-        void getEarthLevels(const std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& colors);
+        // Bind the lookup table to COLORMAP_TEXTURE_UNIT and set its uniforms in the shader program in use
+        void use(GLuint program) const;
 
         // Interpolate between two colors
-        glm::vec3 interpolateColors(const float& y1, const float& y2, const glm::vec3& c1, const glm::vec3& c2, const float& y);
+        glm::vec3 interpolateColors(const float& y1, const float& y2, const glm::vec3& c1, const glm::vec3& c2, const float& y) const;
 
         // Destructor
         ~ColorMap();
@@ -0,0 +1,61 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+View frustum header file. The six clipping planes are extracted from the Model View Projection matrix (Gribb and
+Hartmann), so that the chunks whose bounding box is outside of the view can be skipped before they are drawn.
+*/
+
+#pragma once
+
+// OpenGL
+#include <glm/glm.hpp>                          // OpenGL Mathematics
+
+/**
+ * @class Frustum
+ * @brief Six planes (a, b, c, d) of the view frustum in world space, a point p is inside a plane if a.p + d >= 0
+ */
+class Frustum {
+
+    private:
+
+        glm::vec4 m_planes[6];                  // Left, right, bottom, top, near and far planes
+
+    public:
+
+        // Default constructor : the whole space is inside
+        Frustum() {
+            for (glm::vec4& plane : m_planes) {
+                plane = glm::vec4(0, 0, 0, 1);
+            }
+        }
+
+        // Extract the planes of the Model View Projection matrix (OpenGL clip space, -w <= x, y, z <= w)
+        explicit Frustum(const glm::mat4& mvp) {
+            // Rows of the matrix (glm matrices are indexed by column)
+            glm::vec4 row[4];
+            for (int i = 0; i < 4; i++) {
+                row[i] = glm::vec4(mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]);
+            }
+            for (int axis = 0; axis < 3; axis++) {
+                m_planes[2 * axis] = row[3] + row[axis];
+                m_planes[2 * axis + 1] = row[3] - row[axis];
+            }
+        }
+
+        // Check whether an axis-aligned box is at least partly inside: for each plane, its corner furthest along the
+        // plane normal must be inside. Boxes near the frustum corners may be kept, never wrongly culled.
+        bool intersects(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+            for (const glm::vec4& plane : m_planes) {
+                glm::vec3 corner(plane.x >= 0 ? boxMax.x : boxMin.x,
+                                 plane.y >= 0 ? boxMax.y : boxMin.y,
+                                 plane.z >= 0 ? boxMax.z : boxMin.z);
+                if (glm::dot(glm::vec3(plane), corner) + plane.w < 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+};
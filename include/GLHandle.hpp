@@ -0,0 +1,96 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Move-only RAII wrappers for OpenGL object names (buffers, vertex arrays and textures). The name is created on demand and deleted
+by the destructor, so the objects must be created and destroyed on the thread that owns the OpenGL context. A wrapper
+that was never created (or was moved from) holds 0 and does not call OpenGL at all.
+*/
+
+#pragma once
+
+// OpenGL
+#include <GL/glew.h>                            // OpenGL Library
+
+/**
+ * @brief Creation and deletion functions of OpenGL buffers
+ */
+struct GLBufferTraits {
+    static void create(GLuint* name) { glGenBuffers(1, name); }
+    static void destroy(GLuint* name) { glDeleteBuffers(1, name); }
+};
+
+/**
+ * @brief Creation and deletion functions of OpenGL vertex arrays
+ */
+struct GLVertexArrayTraits {
+    static void create(GLuint* name) { glGenVertexArrays(1, name); }
+    static void destroy(GLuint* name) { glDeleteVertexArrays(1, name); }
+};
+
+/**
+ * @brief Creation and deletion functions of OpenGL textures
+ */
+struct GLTextureTraits {
+    static void create(GLuint* name) { glGenTextures(1, name); }
+    static void destroy(GLuint* name) { glDeleteTextures(1, name); }
+};
+
+/**
+ * @class GLHandle
+ * @brief Owns one OpenGL object name
+ */
+template <class Traits>
+class GLHandle {
+
+    private:
+
+        GLuint m_name;      // OpenGL object name, 0 if none
+
+    public:
+
+        // Default constructor : holds no object
+        GLHandle() : m_name(0) {}
+
+        // Move only
+        GLHandle(const GLHandle&) = delete;
+        GLHandle& operator=(const GLHandle&) = delete;
+        GLHandle(GLHandle&& other) noexcept : m_name(other.m_name) { other.m_name = 0; }
+        GLHandle& operator=(GLHandle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_name = other.m_name;
+                other.m_name = 0;
+            }
+            return *this;
+        }
+
+        // Create the object, deleting the previous one if any
+        void create() {
+            reset();
+            Traits::create(&m_name);
+        }
+
+        // Delete the object if any
+        void reset() {
+            if (m_name != 0) {
+                Traits::destroy(&m_name);
+                m_name = 0;
+            }
+        }
+
+        // Get the object name
+        GLuint get() const { return m_name; }
+
+        // Check whether an object is held
+        explicit operator bool() const { return m_name != 0; }
+
+        // Destructor : deletes the object
+        ~GLHandle() { reset(); }
+};
+
+typedef GLHandle<GLBufferTraits> GLBuffer;              // OpenGL buffer object (VBO, EBO)
+typedef GLHandle<GLVertexArrayTraits> GLVertexArray;    // OpenGL vertex array object (VAO)
+typedef GLHandle<GLTextureTraits> GLTexture;            // OpenGL texture object
@@ -0,0 +1,58 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Horizon Culler class header file. The occlusion horizon is the elevation, for each azimuth around the camera, under
+which every view ray hits the terrain within some distance. It is raised front to back by the tiles of the chunks'
+coarse min/max height grids, and a chunk whose bounding box stays under the horizon everywhere is hidden behind nearer
+terrain. The camera must be above the terrain.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+
+// OpenGL
+#include <glm/glm.hpp>                          // OpenGL Mathematics
+
+/**
+ * @class HorizonCuller
+ * @brief Conservative occlusion horizon over azimuth bins, in slopes (tangent of the elevation) to avoid the arc tangents
+ *
+ * A point P at height h under the terrain at its xz position hides every ray with the azimuth of P and a lower slope: at
+ * the horizontal distance of P, such a ray is under P and so under the terrain, which it has crossed from above. The
+ * top of a tile's min box is such a set of points, and only raises the horizon over the bins it fully covers.
+ */
+class HorizonCuller {
+
+    private:
+
+        glm::vec3 m_eye;                        // Camera position
+        std::vector<float> m_horizon;           // Slope of the horizon in each azimuth bin
+
+        // Get the azimuth range [low, high] of the xz footprint of a box, false if the camera is over it
+        bool azimuthRange(const glm::vec3& boxMin, const glm::vec3& boxMax, float& low, float& high) const;
+
+    public:
+
+        // Constructor
+        explicit HorizonCuller(unsigned int bins = 2048);
+
+        // Lower the horizon under every ray, for a new frame seen from a camera position
+        void begin(glm::vec3 eye);
+
+        // Raise the horizon with the top of a tile's min box (at the height of boxMin)
+        void addOccluder(const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+        // Check whether a box is under the horizon, the occluders added must all be nearer than it (horizontally)
+        bool occluded(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+        // Get the horizontal distance from the camera to the nearest point of the xz footprint of a box
+        float nearDistance(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+        // Get the horizontal distance from the camera to the farthest point of the xz footprint of a box
+        float farDistance(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+};
@@ -0,0 +1,76 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+MPSC Queue class header file. An unbounded lock-free queue with many producers and a single consumer, used by the
+chunk workers to hand the finished chunks over to the render thread without a mutex on the frame path. It is an
+intrusive linked list with a stub node: producers swap themselves in as the new head with one atomic exchange, and the
+consumer walks the list from its tail.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <atomic>
+#include <utility>
+
+/**
+ * @class MPSCQueue
+ * @brief Lock-free multi-producer single-consumer queue. push() may be called from any thread, tryPop() from one
+ * thread only. T must be default constructible and movable.
+ *
+ * A push is visible to the consumer once its producer has linked it, so tryPop() may briefly miss an element whose
+ * producer was preempted between the exchange and the link; it is returned by a later call.
+ */
+template <typename T>
+class MPSCQueue {
+
+    private:
+
+        // A node of the list, the node at the tail is the stub whose value was already popped
+        struct Node {
+            std::atomic<Node*> next{nullptr};
+            T value;
+        };
+
+        std::atomic<Node*> m_head;      // Last pushed node, swapped by the producers
+        Node* m_tail;                   // Stub node, owned by the consumer
+
+    public:
+
+        // Constructor
+        MPSCQueue() : m_head(new Node()), m_tail(m_head.load()) {}
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        // Destructor, frees the elements that were not popped. No producer may run anymore.
+        ~MPSCQueue() {
+            T value;
+            while (tryPop(value)) {
+            }
+            delete m_tail;
+        }
+
+        // Append a value, callable from any thread
+        void push(T&& value) {
+            Node* node = new Node();
+            node->value = std::move(value);
+            Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        // Take the oldest value, returns false if the queue is empty. Consumer thread only.
+        bool tryPop(T& value) {
+            Node* next = m_tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return false;
+            }
+            value = std::move(next->value);
+            delete m_tail;
+            m_tail = next; // The popped node becomes the stub
+            return true;
+        }
+};
@@ -26,6 +26,56 @@ declaration for the GradientNoise class.
  */
 uint32_t lfsr(uint32_t seed, size_t shifts);
 
+/**
+ * @author Matt Luyten
+ * @brief Hashes a seed and an integer lattice position into a pseudorandom 32-bit number in constant time.
+ * Unlike lfsr, the cost does not depend on the distance of (x, y) from the origin.
+ *
+ * @param seed the noise seed
+ * @param x the x position on the lattice
+ * @param y the y position on the lattice
+ *
+ * @returns a pseudorandom number, identical for identical inputs
+ */
+uint32_t latticeHash(uint32_t seed, int x, int y);
+
+/**
+ * @author Matt Luyten
+ * @enum SimdLevel
+ * @brief Instruction sets the batched noise kernel can run on, from narrowest to widest
+ */
+enum class SimdLevel
+{
+    SCALAR,     // Plain C++, one sample at a time
+    SSE2,       // 128-bit lanes
+    AVX2,       // 256-bit lanes
+    AVX512,     // 512-bit lanes
+};
+
+/**
+ * @author Matt Luyten
+ * @brief Detects the widest instruction set supported by both the CPU and this build
+ *
+ * @returns the widest supported SIMD level
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @author Matt Luyten
+ * @brief Gets a printable name for a SIMD level
+ *
+ * @param level the SIMD level
+ *
+ * @returns the name of the level
+ */
+const char* simdLevelName(SimdLevel level);
+
+// Arguments of the batched noise kernels, see PerlinKernel.hpp
+struct NoiseRowArgs;
+
+// Batched noise kernel, specialized on an instruction set, a noise mode and a number of octaves
+typedef void (*NoiseRowKernel)(const NoiseRowArgs&);
+
 /**
  * Quintic interpolation function: f(t) = 6 * t^5 - 15 * t^4 + 10 * t^3 
  * 
@@ -148,12 +198,195 @@ public:
      * 
      * @return noise value at position (x,y)
      */
-    void fractalPerlin2D(glm::vec3& pos, double max=1, int mode=0, int octaves=8, double freqStart=0.025, 
+    void fractalPerlin2D(glm::vec3& pos, double max=1, int mode=0, int octaves=8, double freqStart=0.025,
             double freqRate=2, double ampRate=0.5);
+
+    /**
+     * @author Matt Luyten
+     * @brief Contiguous block of 2D lattice gradients covering [x0, x0 + width) x [y0, y0 + height). A tile is built
+     * once per chunk and octave before sampling, so that samples read their gradients from a flat array without locking.
+     */
+    class GradientTile {
+    public:
+        /**
+         * @author Matt Luyten
+         * @brief Empty tile constructor
+         */
+        GradientTile();
+
+        /**
+         * @author Matt Luyten
+         * @brief Allocates a tile covering the given lattice rectangle. Gradients are left uninitialized.
+         *
+         * @param x0 the smallest lattice x position in the tile
+         * @param y0 the smallest lattice y position in the tile
+         * @param width number of lattice positions along x
+         * @param height number of lattice positions along y
+         */
+        GradientTile(int x0, int y0, int width, int height);
+
+        /**
+         * @author Matt Luyten
+         * @brief Gets gradient at integer position (x, y). The position must lie inside the tile.
+         *
+         * @param x the x position of the desired gradient
+         * @param y the y position of the desired gradient
+         *
+         * @return the gradient at (x, y)
+         */
+        const glm::vec2& at(int x, int y) const { return _gradients[(y - _y0) * _width + (x - _x0)]; }
+
+        int x0() const { return _x0; }          // Smallest lattice x position
+        int y0() const { return _y0; }          // Smallest lattice y position
+        int width() const { return _width; }    // Number of lattice positions along x
+        int height() const { return _height; }  // Number of lattice positions along y
+        const glm::vec2* data() const { return _gradients.data(); } // Row-major gradients, for the batched kernels
+
+    private:
+        friend class GradientNoise;
+        int _x0, _y0, _width, _height;
+        std::vector<glm::vec2> _gradients; // Row-major gradients, indexed by (y - y0) * width + (x - x0)
+    };
+
+    /**
+     * @author Matt Luyten
+     * @brief Builds the gradient tile needed to sample perlin2D over the rectangle [xMin, xMax] x [yMin, yMax].
+     * The tile has a margin of one lattice cell on each side so that the float kernels, which may round a sample
+     * onto the neighbouring cell, stay inside it.
+     *
+     * @param xMin smallest x sample position (already scaled by frequency)
+     * @param yMin smallest y sample position (already scaled by frequency)
+     * @param xMax largest x sample position (already scaled by frequency)
+     * @param yMax largest y sample position (already scaled by frequency)
+     *
+     * @return the gradient tile
+     */
+    GradientTile buildTile(double xMin, double yMin, double xMax, double yMax);
+
+    /**
+     * @author Matt Luyten
+     * @brief Builds one gradient tile per octave for fractalPerlin2D over the rectangle [xMin, xMax] x [yMin, yMax].
+     * The frequencies follow the same schedule as fractalPerlin2D.
+     *
+     * @param tiles output vector, resized to the number of octaves
+     * @param xMin smallest x sample position
+     * @param yMin smallest y sample position
+     * @param xMax largest x sample position
+     * @param yMax largest y sample position
+     * @param mode noise mode
+     * @param octaves number of octaves of noise to layer
+     * @param freqStart noise frequency starting value
+     * @param freqRate rate of frequency change between octaves
+     */
+    void buildOctaveTiles(std::vector<GradientTile>& tiles, double xMin, double yMin, double xMax, double yMax,
+            int mode=0, int octaves=8, double freqStart=0.025, double freqRate=2);
+
+    /**
+     * @author Matt Luyten
+     * @brief Same as perlin2D, but reads the gradients from a prebuilt tile instead of the gradient manager
+     *
+     * @param x the input x position for noise value z
+     * @param y the input y position for noise value z
+     * @param tile gradient tile covering the lattice cell of (x, y)
+     *
+     * @return the noise value
+     */
+    glm::vec3 perlin2D(double x, double y, const GradientTile& tile);
+
+    /**
+     * @author Matt Luyten
+     * @brief Same as the vec3 fractalPerlin2D, but reads gradients from per-octave tiles built by buildOctaveTiles.
+     * The number of octaves is the number of tiles.
+     *
+     * @param pos position of the sample, pos.y receives the noise value
+     * @param tiles one gradient tile per octave
+     * @param max maximum value (+/-) of the noise
+     * @param mode noise mode
+     * @param freqStart noise frequency starting value
+     * @param freqRate rate of frequency change between octaves
+     * @param ampRate rate of amplitude change between octaves
+     */
+    void fractalPerlin2D(glm::vec3& pos, const std::vector<GradientTile>& tiles, double max=1, int mode=0,
+            double freqStart=0.025, double freqRate=2, double ampRate=0.5);
+
+    /**
+     * @author Matt Luyten
+     * @brief Batched version of the tiled fractalPerlin2D. Evaluates a row of samples given in SoA form with the widest
+     * SIMD instruction set selected for this generator. Mode 3 gives the same result as mode 0, as in the per-point version.
+     *
+     * @param xs x positions of the samples
+     * @param zs z positions of the samples
+     * @param heights output noise values, one per sample
+     * @param count number of samples
+     * @param tiles one gradient tile per octave, covering every sample
+     * @param max maximum value (+/-) of the noise
+     * @param mode noise mode
+     * @param freqStart noise frequency starting value
+     * @param freqRate rate of frequency change between octaves
+     * @param ampRate rate of amplitude change between octaves
+     */
+    void fractalPerlin2DRow(const float* xs, const float* zs, float* heights, size_t count,
+            const std::vector<GradientTile>& tiles, double max=1, int mode=0,
+            double freqStart=0.025, double freqRate=2, double ampRate=0.5);
+
+    /**
+     * @author Matt Luyten
+     * @brief Selects the batched kernel for a noise mode and a number of octaves, using the SIMD level of this
+     * generator. The kernel is specialized at compile time so that it has no mode branches and, for 4, 6, 8 and 12
+     * octaves, a fully unrolled octave loop. Select it once and reuse it for every row.
+     * The float kernels process twice as many samples per instruction as the double ones. Their error grows with the
+     * lattice coordinates (see test/precision-test.cpp).
+     *
+     * @tparam T scalar type of the computations (float or double)
+     *
+     * @param mode noise mode
+     * @param octaves number of octaves
+     *
+     * @return the kernel
+     */
+    template <typename T = double>
+    NoiseRowKernel rowKernel(int mode, int octaves) const;
+
+    /**
+     * @author Matt Luyten
+     * @brief Same as above, but runs a kernel selected beforehand with rowKernel. The tiles must have been built
+     * with the same mode and number of octaves as the kernel.
+     *
+     * @param kernel kernel returned by rowKernel
+     * @param xs x positions of the samples
+     * @param zs z positions of the samples
+     * @param heights output noise values, one per sample
+     * @param count number of samples
+     * @param tiles one gradient tile per octave, covering every sample
+     * @param max maximum value (+/-) of the noise
+     * @param freqStart noise frequency starting value
+     * @param freqRate rate of frequency change between octaves
+     * @param ampRate rate of amplitude change between octaves
+     */
+    void fractalPerlin2DRow(NoiseRowKernel kernel, const float* xs, const float* zs, float* heights, size_t count,
+            const std::vector<GradientTile>& tiles, double max=1, double freqStart=0.025, double freqRate=2, double ampRate=0.5);
+
+    /**
+     * @author Matt Luyten
+     * @brief Gets the SIMD level used by fractalPerlin2DRow
+     *
+     * @return the SIMD level
+     */
+    SimdLevel simdLevel() const { return _simdLevel; }
+
+    /**
+     * @author Matt Luyten
+     * @brief Sets the SIMD level used by fractalPerlin2DRow. Levels wider than detectSimdLevel() are clamped to it.
+     *
+     * @param level the requested SIMD level
+     */
+    void setSimdLevel(SimdLevel level);
 private:
     /**
      * @author Matt Luyten
-     * @brief Keeps track of the 2D gradients in this noise generator.
+     * @brief Generates the 2D gradients of this noise generator. Gradients are a pure function of the seed and the
+     * lattice position, so they are not cached and concurrent callers need no lock. Bulk users should go through
+     * GradientTile instead.
      */
     class Gradient2 {
     public:
@@ -196,8 +429,6 @@ private:
          * @return a random gradient
          */
         glm::vec2 generate(int x, int y);
-        std::map<std::pair<int, int>, glm::vec2> _gradients;
-        std::mutex _m;
         uint32_t _seed;
     };
 
@@ -239,4 +470,5 @@ private:
 
     Gradient1 _gradient1; // 2D gradient manager
     Gradient2 _gradient2; // 1D gradient manager
+    SimdLevel _simdLevel; // Instruction set used by the batched kernel
 };
\ No newline at end of file
@@ -0,0 +1,242 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Batched fractal perlin kernel shared by the SIMD translation units. The kernel is written once against a "lanes"
+policy that wraps the vector type and intrinsics of one instruction set and scalar type, and is specialized at compile
+time on the noise mode and the number of octaves. Single precision doubles the number of lanes of every instruction
+set. Each of PerlinSSE2.cpp, PerlinAVX2.cpp and PerlinAVX512.cpp is compiled with the flags of its instruction set and
+instantiates the kernel family with its own policies. GradientNoise::rowKernel picks the widest one the CPU supports
+at runtime.
+
+Note: the kernel only reads plain data from NoiseRowArgs and does not call inline functions shared with other
+translation units. Otherwise the linker could keep a copy compiled for AVX and call it from generic code.
+*/
+
+#pragma once
+#include <cmath>
+#include <cstring>
+#include "Perlin.hpp"
+
+// SIMD kernels are only built for x86 targets, other targets use the scalar kernel
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PERLIN_X86 1
+#else
+#define PERLIN_X86 0
+#endif
+
+// Ask the compiler to fully unroll the octave loop when its bound is a compile-time constant
+#if defined(__GNUC__)
+#define PERLIN_UNROLL _Pragma("GCC unroll 16")
+#else
+#define PERLIN_UNROLL
+#endif
+
+/**
+ * @author Matt Luyten
+ * @brief Plain view of one octave's gradient tile, read by the kernels
+ */
+struct OctaveTile {
+    const glm::vec2* gradients;     // Row-major gradients of the tile
+    double x0;                      // Smallest lattice x position
+    double y0;                      // Smallest lattice y position
+    int width;                      // Number of lattice positions along x
+};
+
+/**
+ * @author Matt Luyten
+ * @brief Arguments of one batched kernel call
+ */
+struct NoiseRowArgs {
+    const float* xs;                // x positions of the samples
+    const float* zs;                // z positions of the samples
+    float* heights;                 // output noise values
+    size_t count;                   // number of samples
+    const OctaveTile* tiles;        // one gradient tile per octave
+    int octaves;                    // number of octaves, only read by the kernels that are not specialized on it
+    double max;                     // maximum value (+/-) of the noise
+    double freqStart;               // starting frequency
+    double freqRate;                // rate of frequency change between octaves
+    double ampRate;                 // rate of amplitude change between octaves
+};
+
+/**
+ * @author Matt Luyten
+ * @brief Scalar lanes policy, used when no SIMD instruction set is available
+ *
+ * @tparam T scalar type of the computations (float or double)
+ */
+template <typename T>
+struct ScalarLanes {
+    typedef T V;    // Vector of T
+    typedef int I;  // Vector of tile indices
+    static const size_t width = 1;
+
+    static V loadf(const float* p) { return *p; }
+    static void storef(float* p, V v) { *p = static_cast<float>(v); }
+    static V set1(double d) { return static_cast<T>(d); }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V fmadd(V a, V b, V c) { return a * b + c; }
+    static V abs(V a) { return std::fabs(a); }
+    static V floor(V a) { return std::floor(a); }
+    static I index(V row, V col, int width) { return static_cast<int>(row) * width + static_cast<int>(col); }
+    static I addi(I a, int b) { return a + b; }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        gx = g[idx].x;
+        gy = g[idx].y;
+    }
+};
+
+/**
+ * @author Matt Luyten
+ * @brief Evaluates fractal perlin noise for a row of samples, L::width samples at a time.
+ * The last incomplete group is padded with the last sample so that every sample goes through the same code.
+ * Products and sums are written as fused multiply-adds so that the FMA instruction sets can use them.
+ *
+ * @tparam L lanes policy of the instruction set and scalar type
+ * @tparam Mode noise mode (0 - fractal, 1 - turbulent, 2 - opalescent). Mode 3 uses the mode 0 kernel.
+ * @tparam Octaves number of octaves, or 0 to read it from the arguments
+ *
+ * @param a the kernel arguments
+ */
+template <class L, int Mode, int Octaves>
+void fractalRowKernel(const NoiseRowArgs& a) {
+    typedef typename L::V V;
+    typedef typename L::I I;
+    const bool useAbs = (Mode == 1 || Mode == 2); // Turbulent and opalescent use the magnitude of the noise
+    const int octaves = Octaves > 0 ? Octaves : a.octaves;
+
+    float padX[L::width], padZ[L::width], padH[L::width]; // Staging for the last incomplete group
+    for (size_t i = 0; i < a.count; i += L::width) {
+        size_t n = a.count - i < L::width ? a.count - i : L::width;
+        const float* px = a.xs + i;
+        const float* pz = a.zs + i;
+        float* ph = a.heights + i;
+        if (n < L::width) {
+            for (size_t j = 0; j < L::width; j++) { // Pad by repeating the last sample
+                padX[j] = a.xs[i + (j < n ? j : n - 1)];
+                padZ[j] = a.zs[i + (j < n ? j : n - 1)];
+            }
+            px = padX;
+            pz = padZ;
+            ph = padH;
+        }
+
+        V x = L::loadf(px);
+        V z = L::loadf(pz);
+        V height = L::set1(0);
+        double freq = useAbs ? a.freqStart / 2 : a.freqStart; // Make all modes similarly bumpy at the same frequency
+        double amplitude = 1; // Set starting amplitude
+        PERLIN_UNROLL
+        for (int k = 0; k < octaves; k++) { // Iterate for k octaves
+            const OctaveTile& tile = a.tiles[k];
+            V sx = L::mul(x, L::set1(freq));
+            V sz = L::mul(z, L::set1(freq));
+            V fx = L::floor(sx);
+            V fz = L::floor(sz);
+            V u = L::sub(sx, fx); // Fractional components
+            V v = L::sub(sz, fz);
+            V um1 = L::sub(u, L::set1(1));
+            V vm1 = L::sub(v, L::set1(1));
+
+            // Tile indices of the four corners
+            I idx00 = L::index(L::sub(fz, L::set1(tile.y0)), L::sub(fx, L::set1(tile.x0)), tile.width);
+            I idx01 = L::addi(idx00, tile.width);
+            V gx, gy;
+            L::gather(tile.gradients, idx00, gx, gy);
+            V n00 = L::fmadd(gx, u, L::mul(gy, v));
+            L::gather(tile.gradients, L::addi(idx00, 1), gx, gy);
+            V n10 = L::fmadd(gx, um1, L::mul(gy, v));
+            L::gather(tile.gradients, idx01, gx, gy);
+            V n01 = L::fmadd(gx, u, L::mul(gy, vm1));
+            L::gather(tile.gradients, L::addi(idx01, 1), gx, gy);
+            V n11 = L::fmadd(gx, um1, L::mul(gy, vm1));
+
+            // Quintic ease curves ((6t - 15)t + 10)t^3
+            V eu = L::mul(L::fmadd(L::fmadd(L::set1(6), u, L::set1(-15)), u, L::set1(10)), L::mul(u, L::mul(u, u)));
+            V ev = L::mul(L::fmadd(L::fmadd(L::set1(6), v, L::set1(-15)), v, L::set1(10)), L::mul(v, L::mul(v, v)));
+
+            // Interpolate along x, then along z
+            V nx0 = L::fmadd(eu, L::sub(n10, n00), n00);
+            V nx1 = L::fmadd(eu, L::sub(n11, n01), n01);
+            V noise = L::fmadd(ev, L::sub(nx1, nx0), nx0);
+
+            height = L::fmadd(L::set1(amplitude), useAbs ? L::abs(noise) : noise, height);
+            amplitude *= a.ampRate; // Decrease amplitude
+            freq *= a.freqRate; // Increase frequency
+        }
+
+        // Scale noise value so that it does not exceed max (opalescent needs a cosine, it is scaled after the store)
+        if (Mode == 1)
+            height = L::fmadd(height, L::set1(2 * a.max), L::set1(-a.max));
+        else if (Mode != 2)
+            height = L::mul(height, L::set1(a.max));
+        L::storef(ph, height);
+        if (Mode == 2) {
+            for (size_t j = 0; j < n; j++)
+                ph[j] = a.max / 5 * cos(2 * 3.14159265358979323846 * ph[j]);
+        }
+
+        if (n < L::width)
+            std::memcpy(a.heights + i, padH, n * sizeof(float));
+    }
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the kernel specialized on the number of octaves, for the common octave counts
+ *
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <class L, int Mode>
+NoiseRowKernel selectOctaveKernel(int octaves) {
+    switch (octaves) {
+        case 4:
+            return fractalRowKernel<L, Mode, 4>;
+        case 6:
+            return fractalRowKernel<L, Mode, 6>;
+        case 8:
+            return fractalRowKernel<L, Mode, 8>;
+        case 12:
+            return fractalRowKernel<L, Mode, 12>;
+        default:
+            return fractalRowKernel<L, Mode, 0>;
+    }
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the kernel specialized on the noise mode and the number of octaves
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <class L>
+NoiseRowKernel selectRowKernel(int mode, int octaves) {
+    switch (mode) {
+        case 1:
+            return selectOctaveKernel<L, 1>(octaves);
+        case 2:
+            return selectOctaveKernel<L, 2>(octaves);
+        default: // Fractal and gradient weighting
+            return selectOctaveKernel<L, 0>(octaves);
+    }
+}
+
+// Kernel selection, one per instruction set and instantiated for float and double.
+// Only called when detectSimdLevel() reports support.
+template <typename T> NoiseRowKernel rowKernelSSE2(int mode, int octaves);
+template <typename T> NoiseRowKernel rowKernelAVX2(int mode, int octaves);
+template <typename T> NoiseRowKernel rowKernelAVX512(int mode, int octaves);
+
+// Whether the AVX2 and AVX-512 files were compiled with their instruction set enabled
+bool hasAVX2Kernel();
+bool hasAVX512Kernel();
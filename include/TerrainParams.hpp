@@ -0,0 +1,54 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Typed terrain generation parameters. They are read from the command line and validated once in main.cpp, then passed
+by value to the chunk generation code so that the hot path never touches boost::program_options.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @author Matt Luyten
+ * @brief Parameters that define the generated terrain
+ */
+struct TerrainParams {
+    size_t size = 100;              // Number of points per chunk side
+    double resolution = 0.25;       // Distance between points (in meters)
+    unsigned int visibility = 1;    // Number of chunks visible in each direction
+    int octaves = 8;                // Number of octaves of fractal perlin noise
+    uint32_t seed = 0;              // Seed of the perlin noise
+    double freqStart = 0.05;        // Starting frequency
+    double freqRate = 2;            // Rate of frequency change between octaves
+    double ampRate = 0.5;           // Rate of amplitude change between octaves
+    int mode = 0;                   // Noise mode (0 - fractal, 1 - turbulent, 2 - opalescent, 3 - gradient weighting)
+    double max = 5;                 // Maximum value (+/-) of the noise
+    unsigned int precision = 64;    // Noise evaluation precision in bits (32 or 64)
+
+    /**
+     * @author Matt Luyten
+     * @brief Checks that the parameters describe a terrain that can be generated
+     *
+     * @throws std::invalid_argument naming the first invalid parameter
+     */
+    void validate() const;
+
+    /**
+     * @author Matt Luyten
+     * @brief Hashes the parameters that change the generated heights (everything but the visibility). Two parameter
+     * sets with the same hash generate the same chunks, so the hash can be used in cache keys.
+     *
+     * @return 64 bit FNV-1a hash of the parameters
+     */
+    uint64_t hash() const;
+
+    /**
+     * @author Matt Luyten
+     * @brief Gets the size of a chunk in meters
+     */
+    double chunkSize() const { return size * resolution; }
+};
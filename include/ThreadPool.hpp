@@ -0,0 +1,98 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Thread Pool class header file. A fixed number of worker threads, sized to the hardware, run the chunk generation jobs.
+Each worker owns a job queue and steals from the other queues when its own is empty. Every job has a priority (lower
+runs first), so that the chunks nearest to the camera are generated first.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * @class ThreadPool
+ */
+class ThreadPool {
+
+    public:
+
+        typedef std::function<void()> Task;             // Work run by a worker thread
+        typedef std::function<double()> Priority;       // Priority of a job, lower runs first
+
+    private:
+
+        // A queued job, its priority is cached when the job is queued or reprioritized
+        struct Job {
+            Task task;              // Work to run
+            Priority priority;      // Priority function of the job
+            double cachedPriority;  // Last value returned by the priority function
+            uint64_t sequence;      // Submission order, breaks ties between equal priorities
+        };
+
+        // Job queue owned by one worker
+        struct WorkerQueue {
+            std::mutex mut;             // Protects the jobs
+            std::vector<Job> jobs;      // Queued jobs, unordered
+        };
+
+        ///////////////////////////// MEMBER VARIABLES /////////////////////////////
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;    // One job queue per worker
+        std::vector<std::thread> m_workers;                     // Worker threads
+        std::atomic<uint64_t> m_sequence;                       // Next submission number
+        std::atomic<size_t> m_queued;                           // Number of jobs waiting in the queues
+        std::atomic<size_t> m_pending;                          // Number of jobs queued or running
+        std::atomic<uint64_t> m_stolen;                         // Number of jobs run by another worker than their owner
+        bool m_stop;                                            // Set when the pool is destroyed
+
+        // Sleeping workers and wait() callers
+        std::mutex m_sleepMut;                  // Protects m_stop and the condition variables
+        std::condition_variable m_wake;         // Wakes up the workers when a job is queued
+        std::condition_variable m_idle;         // Wakes up wait() callers when the last job is done
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Main loop of a worker thread
+        void workerLoop(size_t index);
+
+        // Take the job with the lowest priority from a queue
+        static bool takeBest(WorkerQueue& queue, Job& job);
+
+    public:
+
+        ///////////////////////////// MEMBER FUNCTIONS /////////////////////////////
+
+        // Constructor, 0 threads uses one thread per hardware thread but the render thread
+        explicit ThreadPool(unsigned int threads = 0);
+
+        // Queue a job
+        void submit(Task task, Priority priority);
+
+        // Evaluate the priority of every queued job again
+        void reprioritize();
+
+        // Wait until every queued job is done
+        void wait();
+
+        // Get the number of worker threads
+        size_t size() const { return m_workers.size(); }
+
+        // Get the number of jobs queued or running
+        size_t pending() const { return m_pending.load(); }
+
+        // Get the number of jobs that were stolen by another worker
+        uint64_t stolen() const { return m_stolen.load(); }
+
+        // Destructor : drops the queued jobs and joins the workers
+        ~ThreadPool();
+};
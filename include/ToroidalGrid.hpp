@@ -0,0 +1,110 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Toroidal Grid class header file. A fixed-capacity 2D grid indexed by chunk coordinates modulo its width. The live
+chunks always fit in a square of (2r+1)^2 chunks around the camera (r the unload distance), so a grid of width 2r+1
+holds each of them in its own slot: lookups are O(1), iteration is contiguous, and moving the square reuses the slots
+of the chunks left behind.
+*/
+
+#pragma once
+
+// Standard libraries
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+/**
+ * @class ToroidalGrid
+ * @brief Fixed-capacity 2D grid wrapping around its width in both directions. Each slot remembers the coordinates it
+ * holds, so that a lookup for coordinates that wrap onto the same slot misses.
+ *
+ * Concurrency: the occupied flag of a slot is atomic. A thread may fill an empty slot while another thread reads the
+ * occupied slots; insertions and erasures must be serialized by the caller.
+ */
+template <typename T>
+class ToroidalGrid {
+
+    private:
+
+        // A slot of the grid
+        struct Slot {
+            std::atomic<bool> occupied{false};  // Whether the slot holds a value
+            std::pair<int, int> coords;         // Coordinates of the value held
+            T value;                            // Value held
+        };
+
+        int m_width;                            // Number of slots along each axis
+        std::unique_ptr<Slot[]> m_slots;        // Row-major slots
+
+        // Get the slot that coordinates map to
+        Slot& slot(std::pair<int, int> coords) const {
+            return m_slots[slotIndex(coords)];
+        }
+
+    public:
+
+        // Constructor
+        explicit ToroidalGrid(int width) : m_width(width), m_slots(new Slot[width * width]) {}
+
+        // Get the number of slots along each axis
+        int width() const { return m_width; }
+
+        // Get the index of the slot that coordinates map to, in [0, width^2). Two values held at once never share it.
+        int slotIndex(std::pair<int, int> coords) const {
+            int x = ((coords.first % m_width) + m_width) % m_width;
+            int z = ((coords.second % m_width) + m_width) % m_width;
+            return z * m_width + x;
+        }
+
+        // Get the value at some coordinates, nullptr if they are not in the grid
+        T* find(std::pair<int, int> coords) const {
+            Slot& s = slot(coords);
+            return s.occupied.load(std::memory_order_acquire) && s.coords == coords ? &s.value : nullptr;
+        }
+
+        // Check whether the slot of some coordinates holds a value, for these coordinates or others
+        bool slotOccupied(std::pair<int, int> coords) const {
+            return slot(coords).occupied.load(std::memory_order_acquire);
+        }
+
+        // Put a value at some coordinates, replacing the value held by their slot
+        T& put(std::pair<int, int> coords, T&& value) {
+            Slot& s = slot(coords);
+            s.occupied.store(false, std::memory_order_release);
+            s.coords = coords;
+            s.value = std::move(value);
+            s.occupied.store(true, std::memory_order_release);
+            return s.value;
+        }
+
+        // Erase the values for which pred(coords, value) is true, returns the number of values erased
+        template <class Pred>
+        size_t eraseIf(Pred pred) {
+            size_t erased = 0;
+            for (int i = 0; i < m_width * m_width; i++) {
+                Slot& s = m_slots[i];
+                if (s.occupied.load(std::memory_order_acquire) && pred(s.coords, s.value)) {
+                    s.occupied.store(false, std::memory_order_release);
+                    s.value = T();
+                    erased++;
+                }
+            }
+            return erased;
+        }
+
+        // Call f(coords, value) for each value, in slot order
+        template <class F>
+        void forEach(F f) {
+            for (int i = 0; i < m_width * m_width; i++) {
+                Slot& s = m_slots[i];
+                if (s.occupied.load(std::memory_order_acquire)) {
+                    f(s.coords, s.value);
+                }
+            }
+        }
+};
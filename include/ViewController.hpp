@@ -24,6 +24,8 @@ by the user inputs, managing the projection and view matrices.
 
 // Standard libraries
 #include <map>
+#include <deque>
+#include <utility>
 
 // Include project header files
 #include "ChunkManager.hpp"
@@ -54,6 +56,8 @@ class ViewController
         sf::Clock clock;                // Clock for the time difference between current and last frame
         float speed;                    // User's displacement speed [m/s]
         float mouseSpeed;               // User's mouse sensitivity [rad/s]
+        float elapsedTime;              // Time since the controller was created [s]
+        std::deque<std::pair<float, glm::vec3>> positionHistory; // Recent (time, position) samples for the velocity
 
         // Projection variables 
         bool perspectiveProjection;     // Perspective projection mode
@@ -115,4 +119,7 @@ class ViewController
         //get the camera's position
         glm::vec3 getPosition();
 
+        // Get the camera's velocity averaged over the recent position history
+        glm::vec3 getVelocity();
+
 };
\ No newline at end of file
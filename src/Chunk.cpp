@@ -11,6 +11,8 @@ The (x,z) coordinates give the location of the point in 2D while the y coordinat
 // Standard libraries
 #include <iostream>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 
 // Header file
 #include "Chunk.hpp"
@@ -32,55 +34,199 @@ Chunk::Chunk(int64_t seed, double chunkSize, double resolution, glm::vec2 chunkC
 	m_preparedToRender = false;
 	m_pointsPerSide = static_cast<unsigned int>(m_chunkSize / m_resolution);
 
-	// Create the height map with zeros
-	heightMap = std::vector<glm::vec3>(m_pointsPerSide * m_pointsPerSide, glm::vec3(0, 0, 0));
+	// Create the height map with zeros (the texture is created by prepareToRender, on the OpenGL thread)
+	heightMap = std::vector<float>(m_pointsPerSide * m_pointsPerSide, 0.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Empty the bounding box of the chunk and the boxes of the coarse height grid, before boundRow adds the rows to
+ * them. The tiles are HEIGHT_TILES_PER_SIDE quads wide at most.
+ */
+void Chunk::resetBounds()
+{
+	m_boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	m_boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+	unsigned int quads = m_pointsPerSide > 0 ? m_pointsPerSide - 1 : 0;
+	m_tileStep = std::max(1u, (quads + HEIGHT_TILES_PER_SIDE - 1) / HEIGHT_TILES_PER_SIDE);
+	m_tilesPerSide = (quads + m_tileStep - 1) / m_tileStep;
+	m_tileBounds.assign(static_cast<size_t>(m_tilesPerSide) * m_tilesPerSide, std::make_pair(m_boundsMin, m_boundsMax));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Grow the bounding box of the chunk and the boxes of the tiles of the coarse height grid to contain one row of
+ * the height map, right after its heights are computed. A row on the border of two tile rows goes to both, so that each
+ * tile bounds the triangles over it.
+ * @param row : row of the height map (x axis)
+ */
+void Chunk::boundRow(unsigned int row)
+{
+	const float* height = &heightMap[static_cast<size_t>(row) * m_pointsPerSide];
+	float rowMin = *std::min_element(height, height + m_pointsPerSide);
+	float rowMax = *std::max_element(height, height + m_pointsPerSide);
+	m_boundsMin = glm::min(m_boundsMin, glm::vec3(point(row, 0).x, rowMin, m_origin.z));
+	m_boundsMax = glm::max(m_boundsMax, glm::vec3(point(row, 0).x, rowMax, point(row, m_pointsPerSide - 1).z));
+
+	// Bounds of the row over the columns of each tile, added to the tile rows the row belongs to
+	unsigned int tileRow = row / m_tileStep;
+	for (unsigned int tileCol = 0; tileCol < m_tilesPerSide; tileCol++) {
+		unsigned int first = tileCol * m_tileStep;
+		unsigned int last = std::min(first + m_tileStep, m_pointsPerSide - 1);
+		float lowest = *std::min_element(height + first, height + last + 1);
+		float highest = *std::max_element(height + first, height + last + 1);
+		glm::vec3 low(point(row, first).x, lowest, point(row, first).z);
+		glm::vec3 high(point(row, last).x, highest, point(row, last).z);
+		if (tileRow < m_tilesPerSide) {
+			auto& tile = m_tileBounds[tileRow * m_tilesPerSide + tileCol];
+			tile.first = glm::min(tile.first, low);
+			tile.second = glm::max(tile.second, high);
+		}
+		if (row % m_tileStep == 0 && tileRow > 0) {
+			auto& tile = m_tileBounds[(tileRow - 1) * m_tilesPerSide + tileCol];
+			tile.first = glm::min(tile.first, low);
+			tile.second = glm::max(tile.second, high);
+		}
+	}
+}
 
-	// Create the texture and image (unititialized)
-	this->texture2D.create(this->m_pointsPerSide, this->m_pointsPerSide);
-	this->image.create(this->m_pointsPerSide, this->m_pointsPerSide);
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Compute the bounding box of the whole height map (for the chunks loaded from the chunk store)
+ */
+void Chunk::computeBounds()
+{
+	this->resetBounds();
+	for (unsigned int row = 0; row < m_pointsPerSide; row++) {
+		this->boundRow(row);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @author Thomas Etheve
- * @brief Initialize the buffers for the chunk
- * @param cmapPointer : Pointer to the color map
+ * @brief Compute, for each level of detail, the largest height difference between the height map and the triangles of
+ * the level, which interpolate the sampled rows and columns. Each quad of a level is split along the same diagonal as
+ * its strips, from (row + 1, col) to (row, col + 1).
  */
-void Chunk::prepareToRender(ColorMap* cmapPointer)
+void Chunk::computeLodErrors()
 {
+	unsigned int n = m_pointsPerSide;
+	unsigned int levels = chunkLodLevels(n);
+	m_lodErrors.assign(levels, 0.0f);
+	auto height = [this, n](unsigned int row, unsigned int col) { return heightMap[static_cast<size_t>(row) * n + col]; };
+
+	for (unsigned int level = 1; level < levels; level++) {
+		std::vector<unsigned int> samples = lodSamples(n, 1u << level);
+		float error = 0;
+		for (size_t i = 0; i + 1 < samples.size(); i++) {
+			for (size_t j = 0; j + 1 < samples.size(); j++) {
+				unsigned int r0 = samples[i], r1 = samples[i + 1], c0 = samples[j], c1 = samples[j + 1];
+				float h00 = height(r0, c0), h10 = height(r1, c0), h01 = height(r0, c1), h11 = height(r1, c1);
+				for (unsigned int row = r0; row <= r1; row++) {
+					for (unsigned int col = c0; col <= c1; col++) {
+						float u = static_cast<float>(row - r0) / (r1 - r0);
+						float v = static_cast<float>(col - c0) / (c1 - c0);
+						float interpolated = u + v <= 1 ? h00 + u * (h10 - h00) + v * (h01 - h00)
+														: h11 + (1 - u) * (h01 - h11) + (1 - v) * (h10 - h11);
+						error = std::max(error, std::abs(height(row, col) - interpolated));
+					}
+				}
+			}
+		}
+		m_lodErrors[level] = error;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the heights of the skirt vertices: under the edge vertices, in the order of chunkVertexCount, down to the
+ * lowest height of the chunk. A neighbour's edge at a coarser level interpolates heights of this edge, so it is never
+ * lower and the skirt closes the crack between them.
+ * @return the skirt vertex heights (4N)
+ */
+std::vector<float> Chunk::skirtHeights() const
+{
+	return std::vector<float>(4 * static_cast<size_t>(m_pointsPerSide), m_boundsMin.y);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Allocate the staging buffers. The rows are then staged with stageRow, on any thread.
+ */
+void Chunk::beginStaging()
+{
+	size_t points = static_cast<size_t>(m_pointsPerSide) * m_pointsPerSide;
+	m_pixels.resize(4 * points);
+	m_rowsStaged = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Fill in the 2D texture pixels of one row of the height map, right after its heights are computed so that the row
+ * is still in the cache. The staging buffers must be allocated.
+ * @param row : row of the height map (x axis)
+ * @param cmap : color map
+ */
+void Chunk::stageRow(unsigned int row, const ColorMap& cmap)
+{
+	unsigned int n = m_pointsPerSide;
+	for (unsigned int col = 0; col < n; col++) {
+		// Color of the point
+		glm::vec3 color = cmap.getColor(heightMap[row * n + col]);
+
+		// Pixel (row, col) of the texture (window (i,j) = 3d world (x,z)), black on the border to see the chunk borders in 2D
+		sf::Uint8* pixel = &m_pixels[4 * (static_cast<size_t>(col) * n + row)];
+		bool border = row == 0 || col == 0 || row == n - 1 || col == n - 1;
+		pixel[0] = border ? 0 : static_cast<sf::Uint8>(color.x * 255);
+		pixel[1] = border ? 0 : static_cast<sf::Uint8>(color.y * 255);
+		pixel[2] = border ? 0 : static_cast<sf::Uint8>(color.z * 255);
+		pixel[3] = 255;
+	}
+	m_rowsStaged++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Initialize the buffers for the chunk from the staging buffers. Only OpenGL calls are left to the OpenGL
+ * thread, unless the chunk was not staged by a worker.
+ * @param cmapPointer : Pointer to the color map, used if the chunk is not staged yet
+ * @param indexBuffer : element buffer shared by the chunks with this number of points per side
+ */
+void Chunk::prepareToRender(ColorMap* cmapPointer, const ChunkIndexBuffer& indexBuffer)
+{
+	// Stage the rows here if no worker did
+	this->stageAll(cmapPointer);
+
 	/*
 	* 1. 3D RENDERING STUFF (Buffers)
 	*/
 	// Bind the VAO
-	glGenVertexArrays(1, &(this->vertexArrayObject));
-	glBindVertexArray(this->vertexArrayObject);
-
-	// Get the associated colors
-	std::vector<glm::vec3> colors = cmapPointer->getColorVector(this->heightMap);	
-	
-	// Index generation for triangle strips
-	std::vector<unsigned int> indices_triangles_strips;
-	for (unsigned int i = 0; i < this->m_pointsPerSide - 1; i++) {
-		// For each row, create a triangle strip
-		for (unsigned int j = 0; j < this->m_pointsPerSide; j++) {
-			// Add vertex from bottom row
-			indices_triangles_strips.push_back(i * this->m_pointsPerSide + j);
-			// Add vertex from top row
-			indices_triangles_strips.push_back((i + 1) * this->m_pointsPerSide + j);
-		}
-	}
+	this->vertexArrayObject.create();
+	glBindVertexArray(this->vertexArrayObject.get());
 
-	// Vertex Buffer Object (VBO) for vertices positions
-	glGenBuffers(1, &(this->vertexBuffer));						// Generate the buffer
-	glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer);			// Bind the VBO as the active GL_ARRAY_BUFFER
-	glBufferData(GL_ARRAY_BUFFER, 								// Load data in the active buffer
-				 this->heightMap.size() * sizeof(glm::vec3), 		// Size of the data in bytes
-				 this->heightMap.data(), 							// Pointer to the data
+	// Vertex Buffer Object (VBO) for vertices heights, the shader rebuilds x and z from the vertex index and the chunk origin
+	std::vector<float> skirt = this->skirtHeights();
+	this->vertexBuffer.create();								// Generate the buffer
+	glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer.get());	// Bind the VBO as the active GL_ARRAY_BUFFER
+	glBufferData(GL_ARRAY_BUFFER, 								// Allocate the active buffer
+				 chunkVertexCount(m_pointsPerSide) * sizeof(float), 	// Size of the data in bytes (grid and skirts)
+				 nullptr, 											// Filled in below
 				 GL_STATIC_DRAW);									// Data is static set once
+	glBufferSubData(GL_ARRAY_BUFFER, 0, this->heightMap.size() * sizeof(float), this->heightMap.data());		// Grid
+	glBufferSubData(GL_ARRAY_BUFFER, this->heightMap.size() * sizeof(float), skirt.size() * sizeof(float), skirt.data());	// Skirts
 
 	glVertexAttribPointer(	// Set the active buffer (VBO) as the attribute 0 of the VAO
-		0,                  	// attribute index (0) for vertices positions
-		3,                  	// size of each elemeent (3 floats)
+		0,                  	// attribute index (0) for vertices heights
+		1,                  	// size of each elemeent (1 float)
 		GL_FLOAT,           	// type of each subelement
 		GL_FALSE,           	// normalized?
 		0,						// Offset between consecutive elements
@@ -89,32 +235,8 @@ void Chunk::prepareToRender(ColorMap* cmapPointer)
 
 	glEnableVertexAttribArray(0);  // Enable the buffer for the shader
 
-	// Vetex Buffer Object (VBO) for the colors
-	glGenBuffers(1, &(this->colorBuffer));				// Generate the buffer
-	glBindBuffer(GL_ARRAY_BUFFER, this->colorBuffer);	// Bind the VBO as the active GL_ARRAY_BUFFER
-	glBufferData(GL_ARRAY_BUFFER, 						// Load data in the active buffer
-				 colors.size() * sizeof(glm::vec3), 		// Size of the data in bytes
-				 colors.data(), 							// Pointer to the data
-				 GL_STATIC_DRAW);							// Data is static set once
-	
-	glVertexAttribPointer(	// Set the active buffer (VBO) as the attribute 0 of the VAO
-		1,                  	// attribute index (1) for colors
-		3,                  	// size of each elemeent (3 floats)
-		GL_FLOAT,           	// type of each subelement
-		GL_FALSE,           	// normalized?
-		0,						// Offset between consecutive elements
-		(void*)0            	// Array buffer offset
-	);
-
-	glEnableVertexAttribArray(1);  // Enable the buffer for the shader
-
-	// Element Buffer Object (EBO)
-	glGenBuffers(1, &(this->elementBuffer));						// Generate the buffer	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->elementBuffer);		// Bind the EBO as the active GL_ELEMENT_ARRAY_BUFFER
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 							// Load data in the active buffer
-				indices_triangles_strips.size() * sizeof(unsigned int), 	// Size of the data in bytes
-				indices_triangles_strips.data(), 							// Pointer to the data
-				GL_STATIC_DRAW);											// Data is static set once
+	// Element Buffer Object (EBO), shared with the other chunks: only its binding is stored in the VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.get());		// Bind the shared EBO as the VAO's GL_ELEMENT_ARRAY_BUFFER
 
 	// Unbind VAO
 	glBindVertexArray(0);
@@ -122,30 +244,32 @@ void Chunk::prepareToRender(ColorMap* cmapPointer)
 	/*
 	* 2. 2D RENDERING STUFF (Chunk texture)
 	*/
+	this->createTexture();
 
-	// Go over the pixels and compute the color of the image
-	for(unsigned int i = 0; i < this->m_pointsPerSide; i++)		// Rows - x axis
-	{
-		for(unsigned int j = 0; j < this->m_pointsPerSide; j++)	// Columns - z axis
-		{
-			// Get the color for the current pixel from the 1D color vector
-			glm::vec3 color = colors[i * this->m_pointsPerSide + j];
-			
-			// Set the pixel color (window (i,j) = 3d world (x,z))
-			if(i==0 || j==0 || i==this->m_pointsPerSide-1 || j==this->m_pointsPerSide-1)
-			{
-				// If the pixel is on the border, set it to black (we want to see the chunk borders in 2D)
-				image.setPixel(i, j, sf::Color::Black);
-			}
-			else{
-				// Set the color of the pixel to the one in 3D
-				image.setPixel(i, j, sf::Color(color.x * 255, color.y * 255, color.z * 255));
-			}
-		}
-	}
+	// Set the chunk as prepared to render (flag)
+	m_preparedToRender = true;
+}
 
-	// Initialize the texture from the computed image
-	this->texture2D.update(this->image);
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Initialize the chunk for the multi-draw: its vertices are uploaded to a slot of the chunk batch,
+ * which holds the only vertex array, and only the texture is the chunk's own.
+ * @param cmapPointer : Pointer to the color map, used if the chunk is not staged yet
+ * @param batch : chunk batch, created for chunks with this number of points per side
+ * @param slot : slot of the chunk in the batch, not used by any other live chunk
+ */
+void Chunk::prepareToRender(ColorMap* cmapPointer, ChunkBatch& batch, unsigned int slot)
+{
+	// Stage the rows here if no worker did
+	this->stageAll(cmapPointer);
+
+	// 1. 3D: vertex heights and origin in the slot of the batch
+	batch.upload(slot, this->heightMap, this->skirtHeights(), m_origin);
+	m_batchSlot = static_cast<int>(slot);
+
+	// 2. 2D: chunk texture
+	this->createTexture();
 
 	// Set the chunk as prepared to render (flag)
 	m_preparedToRender = true;
@@ -154,49 +278,107 @@ void Chunk::prepareToRender(ColorMap* cmapPointer)
 ///////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @author Thomas Etheve
- * @brief Render the 3D chunk
- * @param shaderProgram : pointer to the shader program
+ * @brief Initialize only the 2D texture of the chunk, when the 3D view is not drawn from the chunks (geometry clipmap)
+ * @param cmapPointer : Pointer to the color map, used if the chunk is not staged yet
  */
+void Chunk::prepareTexture(ColorMap* cmapPointer)
+{
+	// Stage the rows here if no worker did
+	this->stageAll(cmapPointer);
+
+	// 2D: chunk texture
+	this->createTexture();
+
+	// Set the chunk as prepared to render (flag)
+	m_preparedToRender = true;
+}
 
-void Chunk::renderChunk(GLuint* shaderProgramPointer)
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Stage every row of the chunk, on the OpenGL thread, if no worker did (chunks loaded from the cache file
+ * without a color map, for instance)
+ * @param cmapPointer : Pointer to the color map
+ */
+void Chunk::stageAll(ColorMap* cmapPointer)
 {
-	// Activate the shader program
-	glUseProgram(*shaderProgramPointer);
-	
-	// Compute the number of strips and vertices per strip
-	unsigned int nStrips = this->m_pointsPerSide-1;
-	unsigned int nVertsPerStrip = this->m_pointsPerSide*2;
-	
-	// Bind the VAO
-	glBindVertexArray(this->vertexArrayObject);
-	
-	// Draw the triangles strips by strips
-	for(unsigned strip = 0; strip < nStrips; strip++)
-	{
-		// Draw the triangles
-		glDrawElements(
-				GL_TRIANGLE_STRIP,		// Drawing mode : triangle strips save the number indices per strip compared to GL_TRIANGLES
-				nVertsPerStrip,  		// Number of indices per strip
-				GL_UNSIGNED_INT,		// Type of the indices
-				(void*)(strip * nVertsPerStrip * sizeof(unsigned int))		// Offset of the first index of the strip in the EBO
-			);
+	if (this->staged()) {
+		return;
 	}
+	this->beginStaging();
+	for (unsigned int row = 0; row < this->m_pointsPerSide; row++) {
+		this->stageRow(row, *cmapPointer);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Create the 2D texture of the chunk and initialize it from the staged pixels
+ */
+void Chunk::createTexture()
+{
+	this->texture2D.reset(new sf::Texture());
+	this->texture2D->create(this->m_pointsPerSide, this->m_pointsPerSide);
+	this->texture2D->update(m_pixels.data());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Render the 3D chunk with its own vertex array, at a level of detail. The caller activates the shader program
+ * and the primitive restart once for all the chunks, and unbinds the VAO after the last one.
+ * @param indexBuffer : element buffer shared by the chunks with this number of points per side, bound to the VAO
+ * @param level : level of detail (0 for the full resolution)
+ * @param originLocation : location of the chunk origin uniform in the shader program
+ */
+void Chunk::renderChunk(const ChunkIndexBuffer& indexBuffer, unsigned int level, GLint originLocation)
+{
+	// Bind the VAO and place the grid
+	glBindVertexArray(this->vertexArrayObject.get());
+	glUniform3fv(originLocation, 1, &m_origin[0]);
 	
-	// Unbind VAO
-	glBindVertexArray(0);
-	
+	// Draw the triangles: the strips of the level in the shared EBO are separated by the restart index, one call draws the chunk
+	glDrawElements(
+			GL_TRIANGLE_STRIP,				// Drawing mode : triangle strips save the number indices per strip compared to GL_TRIANGLES
+			indexBuffer.count(level),		// Number of indices of the level
+			GL_UNSIGNED_INT,				// Type of the indices
+			indexBuffer.offset(level)		// Offset of the first index of the level in the EBO
+		);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Free the buffers and the texture. Must be called on the OpenGL thread. prepareToRender creates them again.
+ */
+void Chunk::releaseRenderData()
+{
+	this->vertexArrayObject.reset();
+	this->vertexBuffer.reset();
+	this->texture2D.reset();
+	m_batchSlot = -1;
+	m_preparedToRender = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @author Thomas Etheve
- * @brief Destructor
+ * @brief Get the memory used by the chunk: the height map and its coarse grid, the staging buffers and, once prepared
+ * to render, the vertex buffer and the texture (the index buffer, the chunk batch and the color map are shared)
+ * @return the memory used (in bytes)
  */
-Chunk::~Chunk()
+size_t Chunk::memoryBytes() const
 {
-	// Cleanup VAO, points VBOn colors VBO and EBO
-	glDeleteVertexArrays(1, &(this->vertexArrayObject));
-	glDeleteBuffers(1, &(this->vertexBuffer));
-	glDeleteBuffers(1, &(this->colorBuffer));
-	glDeleteBuffers(1, &(this->elementBuffer));
-}
\ No newline at end of file
+	size_t points = static_cast<size_t>(this->m_pointsPerSide) * this->m_pointsPerSide;
+	size_t bytes = this->heightMap.capacity() * sizeof(float);
+	bytes += m_tileBounds.capacity() * sizeof(std::pair<glm::vec3, glm::vec3>) + m_lodErrors.capacity() * sizeof(float);
+	bytes += m_pixels.capacity();
+	if (m_preparedToRender) {
+		if (this->vertexBuffer) {
+			bytes += chunkVertexCount(m_pointsPerSide) * sizeof(float);								// Height buffer
+		}
+		bytes += points * 4;																		// RGBA texture
+	}
+	return bytes;
+}
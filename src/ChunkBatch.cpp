@@ -0,0 +1,143 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Batch class implementation file. The Chunk Batch stores the vertex heights of all the live chunks in one vertex
+buffer, one fixed-size slot per chunk, behind a single vertex array with the shared element buffer. All the chunks are
+then drawn with one glMultiDrawElementsBaseVertex call per frame, the base vertex selecting the slot. The origin of the
+chunk in each slot is in a buffer texture, where the shader finds it from the vertex index.
+*/
+
+// Header file
+#include "ChunkBatch.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Check whether the driver supports multi-draw with a base vertex. glewInit must have been called.
+ * @return true if glMultiDrawElementsBaseVertex is available
+ */
+bool ChunkBatch::supported()
+{
+	return GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Allocate the vertex buffers and the origin buffer texture for some number of chunks, without data, and set up
+ * the vertex array
+ * @param slots : number of chunks the batch holds
+ * @param pointsPerSide : number of points per chunk side
+ * @param indexBuffer : element buffer shared by the chunks of this size, must outlive the batch
+ */
+void ChunkBatch::create(unsigned int slots, unsigned int pointsPerSide, const ChunkIndexBuffer& indexBuffer)
+{
+	m_slots = slots;
+	m_slotVertices = static_cast<GLint>(chunkVertexCount(pointsPerSide));
+	m_indexBuffer = &indexBuffer;
+	GLsizeiptr slotVertices = static_cast<GLsizeiptr>(m_slots) * m_slotVertices;
+
+	// Bind the VAO
+	m_vertexArray.create();
+	glBindVertexArray(m_vertexArray.get());
+
+	// Vertex heights of all the slots (attribute 0)
+	m_vertexBuffer.create();
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.get());
+	glBufferData(GL_ARRAY_BUFFER, slotVertices * sizeof(float), nullptr, GL_DYNAMIC_DRAW);		// Slots are rewritten as chunks stream in
+	glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// Shared element buffer
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.get());
+
+	// Unbind VAO
+	glBindVertexArray(0);
+
+	// Origins of the slots, read by the vertex shader through a buffer texture
+	m_originBuffer.create();
+	glBindBuffer(GL_TEXTURE_BUFFER, m_originBuffer.get());
+	glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(m_slots) * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+	m_originTexture.create();
+	glBindTexture(GL_TEXTURE_BUFFER, m_originTexture.get());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_originBuffer.get());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Upload the vertex heights and origin of a chunk to a slot, replacing the chunk that was there
+ * @param slot : slot of the chunk
+ * @param heights : grid vertex heights (N^2)
+ * @param skirt : skirt vertex heights (4N)
+ * @param origin : position of the chunk's first point
+ */
+void ChunkBatch::upload(unsigned int slot, const std::vector<float>& heights, const std::vector<float>& skirt, const glm::vec3& origin)
+{
+	GLintptr first = static_cast<GLintptr>(slot) * m_slotVertices;
+	GLsizeiptr gridBytes = static_cast<GLsizeiptr>(heights.size()) * sizeof(float);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.get());
+	glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(float), gridBytes, heights.data());
+	glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(float) + gridBytes, skirt.size() * sizeof(float), skirt.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glm::vec4 slotOrigin(origin.x, 0, origin.z, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_originBuffer.get());
+	glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(slot) * sizeof(glm::vec4), sizeof(glm::vec4), &slotOrigin[0]);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Empty the draw list, before adding the chunks of a frame
+ */
+void ChunkBatch::clear()
+{
+	m_counts.clear();
+	m_offsets.clear();
+	m_baseVertices.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Add the chunk in a slot to the draw list
+ * @param slot : slot of the chunk
+ * @param level : level of detail of the chunk
+ */
+void ChunkBatch::add(unsigned int slot, unsigned int level)
+{
+	m_counts.push_back(m_indexBuffer->count(level));
+	m_offsets.push_back(m_indexBuffer->offset(level));
+	m_baseVertices.push_back(static_cast<GLint>(slot) * m_slotVertices);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Draw the chunks of the draw list in one call. The restart index is compared before the base vertex is added,
+ * so the shared strips work for every slot, and gl_VertexID includes the base vertex, so the shader finds the slot of a
+ * vertex by dividing it by the vertices per slot. Leaves the batch VAO bound.
+ * @param originUnit : texture unit of the origins buffer texture (GL_TEXTURE0 + i), active texture unit on return
+ * @return the number of chunks drawn
+ */
+size_t ChunkBatch::draw(GLenum originUnit)
+{
+	if (m_counts.empty()) {
+		return 0;
+	}
+	glActiveTexture(originUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, m_originTexture.get());
+	glBindVertexArray(m_vertexArray.get());
+	glMultiDrawElementsBaseVertex(GL_TRIANGLE_STRIP, m_counts.data(), GL_UNSIGNED_INT, m_offsets.data(),
+								  static_cast<GLsizei>(m_counts.size()), m_baseVertices.data());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	return m_counts.size();
+}
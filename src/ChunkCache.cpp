@@ -0,0 +1,94 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Cache class implementation file. The Chunk Cache keeps the chunks that recently left the view distance in memory,
+up to a byte budget, so that a user oscillating around a chunk border does not pay for generating and uploading them
+again. The least recently dropped chunks are evicted first.
+*/
+
+// Header file
+#include "ChunkCache.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Constructor
+ * @param budgetBytes : memory budget of the cached chunks (in bytes), 0 disables the cache
+ */
+ChunkCache::ChunkCache(size_t budgetBytes) : m_budget(budgetBytes), m_bytes(0) {}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Add a dropped chunk. The least recently dropped chunks are evicted until the cache fits in its budget; a
+ * chunk larger than the whole budget is evicted right away.
+ * @param coords : chunk coordinates
+ * @param entry : the chunk and its sprite
+ * @param evicted : receives the evicted chunks, so that the caller can save them and free them on the right thread
+ */
+void ChunkCache::insert(Coords coords, ChunkEntry&& entry, std::vector<Evicted>& evicted) {
+
+	// Replace a stale copy of the same chunk
+	auto found = m_index.find(coords);
+	if (found != m_index.end()) {
+		m_bytes -= found->second->bytes;
+		m_items.erase(found->second);
+		m_index.erase(found);
+	}
+
+	// Add the chunk as the most recently dropped one
+	size_t bytes = entry.chunk.memoryBytes();
+	m_items.push_front(Item{coords, std::move(entry), bytes});
+	m_index[coords] = m_items.begin();
+	m_bytes += bytes;
+
+	// Evict the least recently dropped chunks until the cache fits in its budget
+	while (m_bytes > m_budget && !m_items.empty()) {
+		Item& oldest = m_items.back();
+		m_bytes -= oldest.bytes;
+		m_index.erase(oldest.coords);
+		evicted.emplace_back(oldest.coords, std::move(oldest.entry));
+		m_items.pop_back();
+		m_stats.evictions++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Take a chunk back out of the cache
+ * @param coords : chunk coordinates
+ * @param entry : receives the chunk and its sprite
+ * @return true if the chunk was cached
+ */
+bool ChunkCache::take(Coords coords, ChunkEntry& entry) {
+	auto found = m_index.find(coords);
+	if (found == m_index.end()) {
+		m_stats.misses++;
+		return false;
+	}
+
+	// Move the chunk out and forget it
+	entry = std::move(found->second->entry);
+	m_bytes -= found->second->bytes;
+	m_items.erase(found->second);
+	m_index.erase(found);
+	m_stats.hits++;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Get the cache counters
+ * @return the counters
+ */
+ChunkCacheStats ChunkCache::stats() const {
+	ChunkCacheStats stats = m_stats;
+	stats.bytes = m_bytes;
+	stats.count = m_items.size();
+	return stats;
+}
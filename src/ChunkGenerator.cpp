@@ -0,0 +1,157 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Generator class implementation file. The Chunk Generator fills the height map of a chunk from the typed terrain
+parameters, and stages its 2D texture pixels in the same sweep. It is the generation stage used
+by the Chunk Manager's worker threads.
+*/
+
+// Standard libraries
+#include <vector>
+#include <algorithm>
+
+// Project headers
+#include "ChunkGenerator.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Constructor. Selects the noise kernel once for the whole session.
+ * @param params : validated terrain parameters
+ * @param cmap : color map of the staged rows, nullptr to only fill in the heights
+ */
+ChunkGenerator::ChunkGenerator(const TerrainParams& params, const ColorMap* cmap)
+	: m_params(params), m_gradientNoise(params.seed), m_cmap(cmap) {
+
+	// Select the noise kernel in single or double precision
+	if (m_params.precision == 32) {
+		m_rowKernel = m_gradientNoise.rowKernel<float>(m_params.mode, m_params.octaves);
+	} else {
+		m_rowKernel = m_gradientNoise.rowKernel<double>(m_params.mode, m_params.octaves);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Set the position of a chunk's first height map point, from which the x and z coordinates of the others follow,
+ * without computing the heights
+ * @param chunkCoords : pair of integers representing the chunk's coordinates
+ * @param chunk : chunk created with the size and resolution of the terrain parameters
+ */
+void ChunkGenerator::setOrigin(std::pair<int, int> chunkCoords, Chunk& chunk) const {
+
+	// Calculate the offset for the current chunk
+	float chunkSize = static_cast<float>(m_params.chunkSize());
+	float resolution = static_cast<float>(m_params.resolution);
+	glm::vec3 offset = glm::vec3((chunkSize - resolution) * (chunkCoords.first - 0.5f), 0, (chunkSize - resolution) * (chunkCoords.second - 0.5f));
+	chunk.setOrigin(offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Fill in a chunk's height map, its bounding box and the height errors of its levels of detail. With a color map, each row is staged for rendering right
+ * after its heights are computed, while it is still in the cache. Safe to call from several threads on different chunks.
+ * @param chunkCoords : pair of integers representing the chunk's coordinates
+ * @param chunk : chunk created with the size and resolution of the terrain parameters
+ * @param cancelled : optional check called between rows, generation stops when it returns true
+ * @return number of rows generated, equal to the chunk's points per side unless cancelled
+ */
+int ChunkGenerator::generate(std::pair<int, int> chunkCoords, Chunk& chunk, const std::function<bool()>& cancelled) {
+
+	// Set the position of the first height map point
+	setOrigin(chunkCoords, chunk);
+	int pointsPerSide = chunk.pointsPerSide();
+
+	// Build the gradient tiles covering the chunk for each octave (first and last points are the chunk corners)
+	std::vector<GradientNoise::GradientTile> tiles;
+	glm::vec3 minCorner = chunk.point(0, 0);
+	glm::vec3 maxCorner = chunk.point(pointsPerSide - 1, pointsPerSide - 1);
+	m_gradientNoise.buildOctaveTiles(tiles, minCorner.x, minCorner.z, maxCorner.x, maxCorner.z, m_params.mode,
+									 m_params.octaves, m_params.freqStart, m_params.freqRate);
+
+	// Sample positions of one row in SoA form: x is constant along a row, z is the same for every row
+	std::vector<float> xs(pointsPerSide), zs(pointsPerSide), heights(pointsPerSide);
+	for (int col = 0; col < pointsPerSide; col++) {
+		zs[col] = chunk.point(0, col).z;
+	}
+
+	// Set the y coordinate of the height map points using the batched noise generator, one row at a time
+	chunk.resetBounds();
+	if (m_cmap) {
+		chunk.beginStaging();
+	}
+	for (int row = 0; row < pointsPerSide; row++) {
+		if (cancelled && cancelled()) {
+			return row;
+		}
+		std::fill(xs.begin(), xs.end(), chunk.point(row, 0).x);
+		m_gradientNoise.fractalPerlin2DRow(m_rowKernel, xs.data(), zs.data(), heights.data(), pointsPerSide, tiles, m_params.max,
+										   m_params.freqStart, m_params.freqRate, m_params.ampRate);
+		std::copy(heights.begin(), heights.end(), chunk.heightMap.begin() + static_cast<size_t>(row) * pointsPerSide);
+		chunk.boundRow(row);
+		if (m_cmap) {
+			chunk.stageRow(row, *m_cmap);
+		}
+	}
+	chunk.computeLodErrors();
+
+	return pointsPerSide;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Sample the heights of a regular grid of points, one row of constant x at a time, with the same noise as the
+ * chunks. The gradient tiles are built per row so that they stay small whatever the spacing.
+ * @param x0 : x coordinate of the first row (in meters)
+ * @param z0 : z coordinate of the first column (in meters)
+ * @param spacing : distance between two rows or columns (in meters)
+ * @param rows : number of rows (along x)
+ * @param cols : number of columns (along z)
+ * @param heights : output heights, rows * cols values, x-major
+ */
+void ChunkGenerator::sampleGrid(double x0, double z0, double spacing, int rows, int cols, float* heights) {
+	if (rows <= 0 || cols <= 0) {
+		return;
+	}
+
+	// Sample positions of one row in SoA form, z is the same for every row
+	std::vector<float> xs(cols), zs(cols);
+	for (int col = 0; col < cols; col++) {
+		zs[col] = static_cast<float>(z0 + spacing * col);
+	}
+
+	std::vector<GradientNoise::GradientTile> tiles;
+	for (int row = 0; row < rows; row++) {
+		float x = static_cast<float>(x0 + spacing * row);
+		std::fill(xs.begin(), xs.end(), x);
+		m_gradientNoise.buildOctaveTiles(tiles, x, zs.front(), x, zs.back(), m_params.mode, m_params.octaves,
+										 m_params.freqStart, m_params.freqRate);
+		m_gradientNoise.fractalPerlin2DRow(m_rowKernel, xs.data(), zs.data(), heights + static_cast<size_t>(row) * cols, cols,
+										   tiles, m_params.max, m_params.freqStart, m_params.freqRate, m_params.ampRate);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Compute the bounding box and the level of detail errors, and stage the texture pixels of a chunk whose height map is already filled
+ * in (loaded from the chunk store). Only the bounding box is computed without a color map.
+ * @param chunk : chunk with its height map filled in
+ */
+void ChunkGenerator::stage(Chunk& chunk) const {
+	chunk.computeBounds();
+	chunk.computeLodErrors();
+	if (!m_cmap) {
+		return;
+	}
+	chunk.beginStaging();
+	for (int row = 0; row < chunk.pointsPerSide(); row++) {
+		chunk.stageRow(row, *m_cmap);
+	}
+}
@@ -0,0 +1,206 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk index generation implementation file. Every chunk with the same number of points per side has the same triangle
+strip topology, so its indices are built once, on the CPU, and shared. The strips run over column bands narrow enough
+for the vertices shared by two consecutive strips to still be in the GPU's post-transform vertex cache, and are
+separated by the primitive restart index so that a chunk is drawn in one call. Coarser levels of detail sample every
+2^l-th row and column of the same vertices, and skirts hanging under the chunk edges hide the cracks between
+neighbouring chunks drawn at different levels.
+*/
+
+// Standard libraries
+#include <deque>
+#include <algorithm>
+
+// Header file
+#include "ChunkIndices.hpp"
+
+/**
+ * @author Thomas Etheve
+ * @brief Get the number of vertices of a chunk: the N^2 vertices of the grid (row * N + column), then N skirt vertices
+ * under each edge, in the order first row, last row, first column, last column
+ * @param pointsPerSide : N, the number of points per chunk side
+ * @return the number of vertices
+ */
+size_t chunkVertexCount(unsigned int pointsPerSide)
+{
+    return static_cast<size_t>(pointsPerSide) * pointsPerSide + 4 * static_cast<size_t>(pointsPerSide);
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Get the number of levels of detail of a chunk size. Level l samples every 2^l-th row and column, down to 2
+ * quads per side, and at most CHUNK_MAX_LOD_LEVELS levels.
+ * @param pointsPerSide : N, the number of points per chunk side
+ * @return the number of levels (1 for the full resolution only)
+ */
+unsigned int chunkLodLevels(unsigned int pointsPerSide)
+{
+    unsigned int levels = 1;
+    while (levels < CHUNK_MAX_LOD_LEVELS && pointsPerSide > 1 && (1u << levels) <= (pointsPerSide - 1) / 2) {
+        levels++;
+    }
+    return levels;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Get the rows (or columns) sampled by a level of detail. The last one is always sampled so that the chunk keeps
+ * its extent, the last quad being narrower if the stride does not divide N - 1.
+ * @param pointsPerSide : N, the number of points per chunk side
+ * @param stride : distance between the sampled rows (in rows)
+ * @return the sampled rows, in increasing order
+ */
+std::vector<unsigned int> lodSamples(unsigned int pointsPerSide, unsigned int stride)
+{
+    std::vector<unsigned int> samples;
+    if (pointsPerSide == 0) {
+        return samples;
+    }
+    for (unsigned int i = 0; i < pointsPerSide - 1; i += stride) {
+        samples.push_back(i);
+    }
+    samples.push_back(pointsPerSide - 1);
+    return samples;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Build the triangle strip indices of a chunk. The columns are split in bands of bandQuads quads; each band is
+ * covered by one strip per row, alternating the vertices of the row and of the next one, so that the next strip finds
+ * the (bandQuads + 1) vertices it shares with this one in the vertex cache. The strips are separated by
+ * CHUNK_RESTART_INDEX, each one starts with the same winding order. A stride above 1 builds a coarser level of detail
+ * over the same vertices, the quads spanning stride rows and columns.
+ * @param pointsPerSide : N, the number of points per chunk side (vertex index = row * N + column)
+ * @param bandQuads : width of the bands in quads, 0 to use the widest band that fits in VERTEX_CACHE_SIZE
+ * @param stride : distance between the rows and columns sampled (1 for the full resolution)
+ * @return the indices of the triangle strips
+ */
+std::vector<unsigned int> bandedStripIndices(unsigned int pointsPerSide, unsigned int bandQuads, unsigned int stride)
+{
+    std::vector<unsigned int> indices;
+    if (pointsPerSide < 2) {
+        return indices;
+    }
+
+    // A strip of a band transforms 2 (bandQuads + 1) vertices, the cache must hold them until the next strip
+    if (bandQuads == 0) {
+        bandQuads = VERTEX_CACHE_SIZE / 2 - 1;
+    }
+    std::vector<unsigned int> samples = lodSamples(pointsPerSide, std::max(stride, 1u));
+    unsigned int quads = static_cast<unsigned int>(samples.size()) - 1;
+    unsigned int bands = (quads + bandQuads - 1) / bandQuads;
+    indices.reserve(2 * static_cast<size_t>(quads + 1) * quads + static_cast<size_t>(bands) * quads);
+
+    for (unsigned int firstCol = 0; firstCol < quads; firstCol += bandQuads) {
+        unsigned int lastCol = std::min(firstCol + bandQuads, quads);
+        for (unsigned int row = 0; row < quads; row++) {
+            // End the previous strip
+            if (!indices.empty()) {
+                indices.push_back(CHUNK_RESTART_INDEX);
+            }
+
+            // Strip between this row and the next one, over the columns of the band
+            for (unsigned int col = firstCol; col <= lastCol; col++) {
+                indices.push_back(samples[row] * pointsPerSide + samples[col]);
+                indices.push_back(samples[row + 1] * pointsPerSide + samples[col]);
+            }
+        }
+    }
+    return indices;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Build the triangle strip indices of the skirts of a chunk: one strip per edge, between the edge vertices of a
+ * level of detail and the skirt vertices under them. The strips are separated by CHUNK_RESTART_INDEX and wound to face
+ * outwards, the side from which a crack with a coarser neighbour can be seen.
+ * @param pointsPerSide : N, the number of points per chunk side
+ * @param stride : distance between the edge vertices sampled, the stride of the level of detail
+ * @return the indices of the triangle strips
+ */
+std::vector<unsigned int> skirtStripIndices(unsigned int pointsPerSide, unsigned int stride)
+{
+    std::vector<unsigned int> indices;
+    if (pointsPerSide < 2) {
+        return indices;
+    }
+    unsigned int n = pointsPerSide;
+    unsigned int skirt = n * n;
+    std::vector<unsigned int> samples = lodSamples(n, std::max(stride, 1u));
+
+    // Edge vertex of sample i on each edge, and whether the strip starts with the skirt vertex to face outwards
+    auto edgeVertex = [n](unsigned int edge, unsigned int i) {
+        switch (edge) {
+            case 0: return i;                   // First row
+            case 1: return (n - 1) * n + i;     // Last row
+            case 2: return i * n;               // First column
+            default: return i * n + n - 1;      // Last column
+        }
+    };
+    const bool skirtFirst[4] = {true, false, false, true};
+
+    for (unsigned int edge = 0; edge < 4; edge++) {
+        if (edge > 0) {
+            indices.push_back(CHUNK_RESTART_INDEX);
+        }
+        for (unsigned int i : samples) {
+            unsigned int top = edgeVertex(edge, i);
+            unsigned int bottom = skirt + edge * n + i;
+            indices.push_back(skirtFirst[edge] ? bottom : top);
+            indices.push_back(skirtFirst[edge] ? top : bottom);
+        }
+    }
+    return indices;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Count the vertices transformed to draw triangle strips, with a FIFO post-transform vertex cache. Divided by
+ * the number of triangles, it gives the average cache miss ratio (ACMR) of the index order: 0.5 at best for a grid,
+ * about 1 when no vertex is reused.
+ * @param indices : triangle strip indices, strips separated by CHUNK_RESTART_INDEX
+ * @param cacheSize : number of entries of the vertex cache
+ * @return the number of cache misses
+ */
+size_t stripVertexCacheMisses(const std::vector<unsigned int>& indices, unsigned int cacheSize)
+{
+    std::deque<unsigned int> cache;
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        if (index == CHUNK_RESTART_INDEX || std::find(cache.begin(), cache.end(), index) != cache.end()) {
+            continue;
+        }
+        misses++;
+        cache.push_back(index);
+        if (cache.size() > cacheSize) {
+            cache.pop_front();
+        }
+    }
+    return misses;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Count the non-degenerate triangles of triangle strips (the ones with three distinct vertices)
+ * @param indices : triangle strip indices, strips separated by CHUNK_RESTART_INDEX
+ * @return the number of triangles drawn
+ */
+size_t stripTriangleCount(const std::vector<unsigned int>& indices)
+{
+    size_t triangles = 0;
+    size_t stripStart = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] == CHUNK_RESTART_INDEX) {
+            stripStart = i + 1;
+        } else if (i >= stripStart + 2 && indices[i] != indices[i - 1] && indices[i] != indices[i - 2] &&
+                   indices[i - 1] != indices[i - 2]) {
+            triangles++;
+        }
+    }
+    return triangles;
+}
@@ -9,21 +9,19 @@ deleted, and rendered. It also handles the 2D map view.
 */
 
 // Standard libraries
-#include <map>
 #include <vector>
 #include <omp.h>
-#include <thread>
 #include <atomic>
 #include <stdexcept>
-#include <queue>
 #include <iostream>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <limits>
 
 // OpenGL Mathematics
 #include <glm/glm.hpp>
 
-// Boost lib for command line arguments
-#include <boost/program_options.hpp>
-
 // Project headers
 #include "Chunk.hpp"
 #include "ChunkManager.hpp"
@@ -33,20 +31,63 @@ deleted, and rendered. It also handles the 2D map view.
  * @author Lydia Jameson
  * @brief Constructor
  * @param cmapPointer : pointer to the color map object
- * @param args : command line arguments
+ * @param params : validated terrain parameters
+ * @param cacheOptions : options of the chunk cache and of the persistent chunk store
+ * @param streamingOptions : options of the chunk streaming around the camera
+ * @param renderOptions : options of the 3D rendering of the chunks
  */
-ChunkManager::ChunkManager(ColorMap* cmapPointer, po::variables_map args) : gradientNoise(args["seed"].as<uint32_t>()) {
+ChunkManager::ChunkManager(ColorMap* cmapPointer, const TerrainParams& params, const ChunkCacheOptions& cacheOptions,
+						   const StreamingOptions& streamingOptions, const RenderOptions& renderOptions)
+	: m_generator(params, cmapPointer), m_chunkGrid(2 * (static_cast<int>(params.visibility) + streamingOptions.unloadMargin) + 1),
+	  m_cache(cacheOptions.memoryBytes), m_keepGLBuffers(cacheOptions.keepGLBuffers) {
 	
-	// Initialize member variables using the command line arguments
-	m_viewDist = args["visibility"].as<unsigned int>();
-	m_seed = args["seed"].as<uint32_t>();
-	m_chunkSize = args["size"].as<size_t>()*args["resolution"].as<double>();
-	m_resolution = static_cast<float>(args["resolution"].as<double>());
+	// Initialize member variables using the terrain parameters
+	m_viewDist = static_cast<int>(params.visibility);
+	m_unloadDist = m_viewDist + streamingOptions.unloadMargin;
+	m_seed = params.seed;
+	m_chunkSize = params.chunkSize();
+	m_resolution = static_cast<float>(params.resolution);
 	m_cmapPointer = cmapPointer;
 	m_pos = glm::vec3(0, 0, 0);
 	m_prevPos = m_pos;
 	m_center = m_pos;
-	m_args = args;
+	m_centerChunk = std::pair<int, int>(0, 0);
+	m_wantedCenterX = m_centerChunk.first;
+	m_wantedCenterZ = m_centerChunk.second;
+	m_prefetchTime = streamingOptions.prefetchTime;
+	m_prefetchChunk = m_centerChunk;
+	m_prefetchCenterX = m_prefetchChunk.first;
+	m_prefetchCenterZ = m_prefetchChunk.second;
+	m_lastStep = std::pair<int, int>(0, 0);
+	m_uploadBudgetMs = streamingOptions.uploadBudgetMs;
+	m_uploadCostMs = 0;
+
+	// Fall back to one draw call per chunk if the driver lacks glMultiDrawElementsBaseVertex
+	m_occlusion = renderOptions.occlusion;
+	m_lodPixels = renderOptions.lodPixels;
+	m_textureOnly = renderOptions.textureOnly;
+	m_multiDraw = renderOptions.multiDraw && !m_textureOnly && ChunkBatch::supported();
+	if (renderOptions.multiDraw && !m_textureOnly && !m_multiDraw) {
+		std::cerr << "Multi-draw not supported (OpenGL 3.2 required), drawing one chunk per call" << std::endl;
+	}
+
+	// A visible chunk is at most (viewDist + 1/2) chunks away from the camera along each axis, so this offset puts
+	// every prefetched chunk behind every visible one
+	double farthest = (m_viewDist + 1) * static_cast<double>(m_chunkSize);
+	m_prefetchPenalty = 2 * farthest * farthest;
+
+	std::cout << "Noise kernel: " << simdLevelName(m_generator.gradientNoise().simdLevel()) << ", "
+		<< params.precision << " bit" << std::endl;
+
+	// Open the chunk store, keyed by the hash of the terrain parameters. Run without it if it cannot be opened.
+	if (!cacheOptions.directory.empty()) {
+		try {
+			m_store.reset(new ChunkStore(cacheOptions.directory, params.hash()));
+			std::cout << "Chunk store: " << cacheOptions.directory << " (" << m_store->stats().entries << " chunks)" << std::endl;
+		} catch (std::exception& e) {
+			std::cerr << "Chunk store disabled: " << e.what() << std::endl;
+		}
+	}
 
 	// Populate the initial chunk map in the view distance (in chunks)
 	for (int i = -m_viewDist; i <= m_viewDist; i++) {
@@ -60,11 +101,14 @@ ChunkManager::ChunkManager(ColorMap* cmapPointer, po::variables_map args) : grad
 			if (currentPair == std::pair<int, int>(0, 0)) {
 				populateChunk(currentPair);
 			} else {
-				// If the current chunk is not at the center, add it to the thread vector
-				threadVector.emplace_back(&ChunkManager::populateChunk, this, currentPair);
+				// If the current chunk is not at the center, queue it for the worker threads
+				requestChunk(currentPair);
 			}
 		}
 	}
+
+	// Put the initial chunk in the chunk grid
+	collectChunks();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -72,145 +116,674 @@ ChunkManager::ChunkManager(ColorMap* cmapPointer, po::variables_map args) : grad
  * @author Lydia Jameson
  * @brief create and destroy chunks based on camera position
  * @param pos : user's position (camera)
+ * @param velocity : user's velocity, used to prefetch the chunks ahead of the camera
  */
-void ChunkManager::update(glm::vec3 pos){
+void ChunkManager::update(glm::vec3 pos, glm::vec3 velocity){
 
 	// Update the previous and current position
 	m_prevPos = m_pos;
 	m_pos = pos;
 
-	// Compute the movement direction and distance from the center
-	glm::vec3 direction = m_pos - m_prevPos;
-	glm::vec3 distanceFromCenter = m_pos - m_center;
+	// Move the chunks finished since the last frame to the chunk grid, or to the chunk cache where the requests below
+	// find the prefetched ones
+	collectChunks();
+
+	// Chunks to generate, queued once the new center is published to the workers
+	std::vector<std::pair<int, int>> requests;
+	std::pair<int, int> previousCenter = m_centerChunk;
 
 	//need new chunks in the +x direction
 	if (m_pos.x > m_center.x + m_chunkSize / 2) {
-		for (int i = m_center.z / m_chunkSize - m_viewDist; i <= m_center.z / m_chunkSize + m_viewDist; i++) {
-
-			std::pair<int, int> currentPair(m_center.x / m_chunkSize + m_viewDist + 1, i);
-			threadVector.emplace_back(&ChunkManager::populateChunk, this, currentPair);
+		m_centerChunk.first++;
+		for (int i = m_centerChunk.second - m_viewDist; i <= m_centerChunk.second + m_viewDist; i++) {
+			requests.push_back(std::pair<int, int>(m_centerChunk.first + m_viewDist, i));
 		}
-		m_center.x += m_chunkSize;
+		m_center.x = m_centerChunk.first * m_chunkSize;
 	}
 
 	//need new chunks in the -x direction
 	if (m_pos.x < m_center.x - m_chunkSize / 2) {
-		for (int i = m_center.z / m_chunkSize - m_viewDist; i <= m_center.z / m_chunkSize + m_viewDist; i++) {
-
-			std::pair<int, int> currentPair(m_center.x / m_chunkSize - m_viewDist - 1, i);
-			threadVector.emplace_back(&ChunkManager::populateChunk, this, currentPair);
+		m_centerChunk.first--;
+		for (int i = m_centerChunk.second - m_viewDist; i <= m_centerChunk.second + m_viewDist; i++) {
+			requests.push_back(std::pair<int, int>(m_centerChunk.first - m_viewDist, i));
 		}
-		m_center.x -= m_chunkSize;
+		m_center.x = m_centerChunk.first * m_chunkSize;
 	}
 
 	//need new chunks in the +z direction
 	if (m_pos.z > m_center.z + m_chunkSize / 2) {
-		for (int i = m_center.x / m_chunkSize - m_viewDist; i <= m_center.x / m_chunkSize + m_viewDist; i++) {
-
-			std::pair<int, int> currentPair(i, m_center.z / m_chunkSize + m_viewDist + 1);
-			threadVector.emplace_back(&ChunkManager::populateChunk, this, currentPair);
+		m_centerChunk.second++;
+		for (int i = m_centerChunk.first - m_viewDist; i <= m_centerChunk.first + m_viewDist; i++) {
+			requests.push_back(std::pair<int, int>(i, m_centerChunk.second + m_viewDist));
 		}
-		m_center.z += m_chunkSize;
+		m_center.z = m_centerChunk.second * m_chunkSize;
 	}
 
 	//need new chunks in the -z direction
 	if (m_pos.z < m_center.z - m_chunkSize / 2) {
-		for (int i = m_center.x / m_chunkSize - m_viewDist; i <= m_center.x / m_chunkSize + m_viewDist; i++) {
-
-			std::pair<int, int> currentPair(i, m_center.z / m_chunkSize - m_viewDist - 1);
-			threadVector.emplace_back(&ChunkManager::populateChunk, this, currentPair);
+		m_centerChunk.second--;
+		for (int i = m_centerChunk.first - m_viewDist; i <= m_centerChunk.first + m_viewDist; i++) {
+			requests.push_back(std::pair<int, int>(i, m_centerChunk.second - m_viewDist));
 		}
-		m_center.z -= m_chunkSize;
+		m_center.z = m_centerChunk.second * m_chunkSize;
 	}
 
-	std::unique_lock<std::mutex> lck(m_mut);
-	//check for chunks that are more than viewDist away
-	for (auto it = chunkMap.begin(); it != chunkMap.end(); it++) {
-		if (abs(it->first.first * m_chunkSize - m_center.x) > m_viewDist * m_chunkSize || abs(it->first.second * m_chunkSize - m_center.z) > m_viewDist * m_chunkSize) {
-			deletionQueue.push(it->first);
+	// Count the center changes, and the ones that step back over the border crossed last along the same axis
+	int stepX = m_centerChunk.first - previousCenter.first;
+	int stepZ = m_centerChunk.second - previousCenter.second;
+	if (stepX != 0) {
+		m_churn.centerMoves++;
+		m_churn.reversals += (stepX == -m_lastStep.first);
+		m_lastStep.first = stepX;
+	}
+	if (stepZ != 0) {
+		m_churn.centerMoves++;
+		m_churn.reversals += (stepZ == -m_lastStep.second);
+		m_lastStep.second = stepZ;
+	}
+
+	// The center moved: publish it to the workers and free the slots of the chunks that are more than the unload
+	// distance away. The chunks between the view and the unload distances stay loaded, so stepping back over a border
+	// loads nothing.
+	if (!requests.empty()) {
+		m_wantedCenterX = m_centerChunk.first;
+		m_wantedCenterZ = m_centerChunk.second;
+		m_chunkGrid.eraseIf([this](std::pair<int, int> coords, ChunkEntry& entry) {
+			if (isKept(coords)) {
+				return false;
+			}
+			m_unloaded.insert(coords);
+			m_churn.unloads++;
+			retainChunk(coords, std::move(entry)); // Keep the dropped chunk in case the user comes back
+			return true;
+		});
+
+		// Forget the unloaded chunks the camera moved far away from, they no longer count as churn
+		for (auto it = m_unloaded.begin(); it != m_unloaded.end();) {
+			if (std::abs(it->first - m_centerChunk.first) > 2 * m_unloadDist ||
+				std::abs(it->second - m_centerChunk.second) > 2 * m_unloadDist) {
+				it = m_unloaded.erase(it);
+			} else {
+				++it;
+			}
 		}
+
+		// Take the new chunks back from the chunk cache, or queue them, unless they are still loaded
+		for (auto& request : requests) {
+			if (m_chunkGrid.find(request)) {
+				continue;
+			}
+			ChunkEntry entry;
+			if (m_cache.take(request, entry)) {
+				if (!m_chunkGrid.slotOccupied(request)) {
+					loadChunk(request, std::move(entry));
+				}
+			} else {
+				requestChunk(request);
+			}
+		}
+	}
+
+	// Queue the chunks the camera is heading to
+	prefetch(velocity);
+
+	// The camera moved: generate the queued chunks nearest to it first
+	if (m_pos != m_prevPos && m_pool.pending() > 0) {
+		m_pool.reprioritize();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Extrapolate the camera position over the look-ahead time and queue the chunks in the view distance of the
+ * predicted center that are neither visible nor cached. Only done when the predicted center chunk changes; the
+ * prefetch jobs that the new prediction leaves out are cancelled like the chunks that leave the view distance.
+ * @param velocity : user's velocity
+ */
+void ChunkManager::prefetch(glm::vec3 velocity) {
+	if (m_prefetchTime <= 0) {
+		return;
 	}
 
-	//delete chunks that are more than viewDist away
-	while (!deletionQueue.empty()) {
+	// Center chunk of the predicted position, with the same rounding as the center chunk
+	glm::vec3 predicted = m_pos + velocity * m_prefetchTime;
+	std::pair<int, int> predictedChunk(static_cast<int>(std::lround(predicted.x / m_chunkSize)),
+									   static_cast<int>(std::lround(predicted.z / m_chunkSize)));
+	if (predictedChunk == m_prefetchChunk) {
+		return;
+	}
+	m_prefetchChunk = predictedChunk;
 
-		// Try to erase the chunk from the 3D chunk map and the sprite map
-		if (chunkMap.erase(deletionQueue.front()) && chunkSprites.erase(deletionQueue.front())) {
-			deletionQueue.pop();
+	// Publish the prediction to the workers, then queue the chunks of the predicted view that are not ready
+	m_prefetchCenterX = predictedChunk.first;
+	m_prefetchCenterZ = predictedChunk.second;
+	for (int i = predictedChunk.first - m_viewDist; i <= predictedChunk.first + m_viewDist; i++) {
+		for (int j = predictedChunk.second - m_viewDist; j <= predictedChunk.second + m_viewDist; j++) {
+			std::pair<int, int> currentPair(i, j);
+			if (!isWanted(currentPair) && !m_chunkGrid.find(currentPair) && !m_cache.contains(currentPair)) {
+				requestChunk(currentPair);
+			}
 		}
 	}
-	lck.unlock();
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @author Lydia Jameson
- * @brief create a chunk and populate its height map. Put chunk in chunkmap
+ * @brief create a chunk and populate its height map. Hand the chunk, or the cancellation of the job, over to the render
+ * thread through the completion queue. Called by the workers.
  * @param currentPair : pair of integers representing the chunk's coordinates
  */
 void ChunkManager::populateChunk(std::pair<int, int> currentPair) {
 
-	// Calculate the offset for the current chunk
-	glm::vec3 offset = glm::vec3((m_chunkSize - m_resolution) * (currentPair.first - 0.5f), 0, (m_chunkSize - m_resolution) * (currentPair.second - 0.5f));
+	// Drop the job if the camera moved away while it was queued
+	int pointsPerSide = static_cast<int>(m_generator.params().size);
+	Completion completion;
+	completion.coords = currentPair;
+	if (!isNeeded(currentPair)) {
+		m_stats.cancelledQueued++;
+		m_stats.rowsSaved += pointsPerSide;
+		completion.cancelled = true;
+		m_completed.push(std::move(completion));
+		return;
+	}
 
 	// Create the temporary chunk
 	Chunk tempChunk(m_seed, m_chunkSize, m_resolution, glm::vec2(currentPair.first, currentPair.second));
 
-	// Populate the height map of the chunk
-	for (int row = 0; row < tempChunk.pointsPerSide(); row++) {
-		for (int col = 0; col < tempChunk.pointsPerSide(); col++) {
+	// Load its heights from the chunk store if it was generated before
+	std::vector<float> heights;
+	if (m_store && m_store->load(currentPair, heights) && heights.size() == tempChunk.heightMap.size()) {
+		m_generator.setOrigin(currentPair, tempChunk);
+		tempChunk.heightMap = std::move(heights);
+		m_generator.stage(tempChunk);
+		m_stats.loaded++;
+	} else {
+		// Otherwise fill in its height map, stop between rows if the chunk is no longer wanted nor prefetched
+		int rows = m_generator.generate(currentPair, tempChunk, [this, currentPair] { return !isNeeded(currentPair); });
+		if (rows < pointsPerSide) {
+			m_stats.cancelledRunning++;
+			m_stats.rowsSaved += pointsPerSide - rows;
+			completion.cancelled = true;
+			m_completed.push(std::move(completion));
+			return;
+		}
+		m_stats.generated++;
+	}
+
+	// Hand the chunk over to the render thread
+	completion.chunk = std::move(tempChunk);
+	m_completed.push(std::move(completion));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Drain the completion queue. A finished chunk goes to its slot of the chunk grid if it is in the unload
+ * distance, to the chunk cache if it is only prefetched, and is dropped otherwise. A cancelled job is queued again if
+ * the camera came back to its chunk after the worker gave up on it. Render thread only.
+ */
+void ChunkManager::collectChunks() {
+	Completion completion;
+	while (m_completed.tryPop(completion)) {
+		std::pair<int, int> currentPair = completion.coords;
+		m_scheduled.erase(currentPair);
+
+		// Queue a cancelled chunk again if it is needed after all
+		if (completion.cancelled) {
+			if ((isWanted(currentPair) || isPrefetched(currentPair)) && !m_chunkGrid.find(currentPair) &&
+				!m_cache.contains(currentPair)) {
+				requestChunk(currentPair);
+			}
+			continue;
+		}
+
+		ChunkEntry entry;
+		entry.chunk = std::move(completion.chunk);
+		if (isKept(currentPair) && !m_chunkGrid.slotOccupied(currentPair)) {
+			// Move the 3D chunk into its slot of the chunk grid (counted in the chunks loaded reported on exit)
+			loadChunk(currentPair, std::move(entry));
+		} else if (!isKept(currentPair) && isPrefetched(currentPair)) {
+			// Keep a prefetched chunk in the chunk cache until the camera gets there
+			retainChunk(currentPair, std::move(entry));
+			m_stats.prefetched++;
+		} else {
+			// Drop the chunk if it went out of range while it was generated, or if another job already loaded it
+			m_stats.discarded++;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Queue the heights of a chunk to be written to the chunk store. The writer thread skips the chunks that are
+ * already stored, so the render thread never waits for the store.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @param chunk : the chunk
+ */
+void ChunkManager::saveChunk(std::pair<int, int> currentPair, Chunk& chunk) {
+	if (!m_store) {
+		return;
+	}
+
+	// Only the heights are stored, the origin is computed again when the chunk is loaded
+	std::vector<float> heights(chunk.heightMap);
+	m_store->storeAsync(currentPair, std::move(heights));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Move a chunk that left the view distance to the chunk cache. Its OpenGL buffers are freed unless they are
+ * retained too. The chunks evicted from the cache are written to the chunk store and freed. Render thread only.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @param entry : the chunk and its sprite
+ */
+void ChunkManager::retainChunk(std::pair<int, int> currentPair, ChunkEntry&& entry) {
+	// A batched chunk's vertices are in the slot of the chunk grid it leaves, which the next chunk there reuses
+	if (!m_keepGLBuffers || entry.chunk.batchSlot() >= 0) {
+		entry.chunk.releaseRenderData();
+	}
+
+	std::vector<ChunkCache::Evicted> evicted;
+	m_cache.insert(currentPair, std::move(entry), evicted);
+	for (auto& item : evicted) {
+		saveChunk(item.first, item.second.chunk); // Write the dropped chunk behind, to reload it if the user comes back
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Check whether a chunk is in the view distance of the last published center. Called by the workers.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @return true if the chunk should be kept
+ */
+bool ChunkManager::isWanted(std::pair<int, int> currentPair) const {
+	return std::abs(currentPair.first - m_wantedCenterX.load()) <= m_viewDist &&
+		   std::abs(currentPair.second - m_wantedCenterZ.load()) <= m_viewDist;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Check whether a chunk is in the unload distance of the last published center. Called by the workers.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @return true if the chunk should stay loaded
+ */
+bool ChunkManager::isKept(std::pair<int, int> currentPair) const {
+	return std::abs(currentPair.first - m_wantedCenterX.load()) <= m_unloadDist &&
+		   std::abs(currentPair.second - m_wantedCenterZ.load()) <= m_unloadDist;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Put a chunk in its slot of the chunk grid and count the load, and the reload if it was unloaded nearby.
+ * Render thread only.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @param entry : the chunk and its sprite
+ */
+void ChunkManager::loadChunk(std::pair<int, int> currentPair, ChunkEntry&& entry) {
+	m_chunkGrid.put(currentPair, std::move(entry));
+	m_churn.loads++;
+	if (m_unloaded.erase(currentPair) > 0) {
+		m_churn.reloads++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Check whether a chunk is in the view distance of the last published predicted center. Called by the workers.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @return true if the chunk should be prefetched
+ */
+bool ChunkManager::isPrefetched(std::pair<int, int> currentPair) const {
+	return m_prefetchTime > 0 &&
+		   std::abs(currentPair.first - m_prefetchCenterX.load()) <= m_viewDist &&
+		   std::abs(currentPair.second - m_prefetchCenterZ.load()) <= m_viewDist;
+}
 
-			// Set the x and z coordinates of the height map point
-			tempChunk.heightMap[row * tempChunk.pointsPerSide() + col].z = offset.z + tempChunk.resolution() * col;
-			tempChunk.heightMap[row * tempChunk.pointsPerSide() + col].x = offset.x + tempChunk.resolution() * row;
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Check whether a chunk is in the unload distance or prefetched. Called by the workers, which cancel the jobs of
+ * the chunks that are not needed.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ * @return true if the chunk is needed
+ */
+bool ChunkManager::isNeeded(std::pair<int, int> currentPair) const {
+	return isKept(currentPair) || isPrefetched(currentPair);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Get a snapshot of the chunk generation counters
+ * @return the counters
+ */
+GenerationStats ChunkManager::generationStats() const {
+	GenerationStats stats;
+	stats.generated = m_stats.generated.load();
+	stats.loaded = m_stats.loaded.load();
+	stats.cancelledQueued = m_stats.cancelledQueued.load();
+	stats.cancelledRunning = m_stats.cancelledRunning.load();
+	stats.discarded = m_stats.discarded.load();
+	stats.rowsSaved = m_stats.rowsSaved.load();
+	stats.prefetched = m_stats.prefetched.load();
+	return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Queue the generation of a chunk on the worker threads, unless it already has a job. The priority is the
+ * squared distance from the chunk to the camera, plus an offset for the chunks that are only prefetched, evaluated
+ * again by update() when the camera moves. Render thread only.
+ * @param currentPair : pair of integers representing the chunk's coordinates
+ */
+void ChunkManager::requestChunk(std::pair<int, int> currentPair) {
+	if (!m_scheduled.insert(currentPair).second) {
+		return;
+	}
+	m_pool.submit([this, currentPair] { populateChunk(currentPair); },
+				  [this, currentPair] {
+					  float dx = currentPair.first * m_chunkSize - m_pos.x;
+					  float dz = currentPair.second * m_chunkSize - m_pos.z;
+					  double priority = static_cast<double>(dx * dx + dz * dz);
+					  return isWanted(currentPair) ? priority : priority + m_prefetchPenalty;
+				  });
+}
 
-			// Set the y coordinate of the height map point using the noise generator
-			gradientNoise.fractalPerlin2D(tempChunk.heightMap[row * tempChunk.pointsPerSide() + col], m_args["max"].as<double>(), m_args["mode"].as<int>(), 
-										  m_args["octaves"].as<int>(), m_args["freq-start"].as<double>(), m_args["freq-rate"].as<double>(), m_args["amp-rate"].as<double>());
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Prepare to render the chunks that are not prepared yet (buffers and 2D texture), nearest to the camera
+ * first, until the upload budget of the frame is spent. An upload is not started if the average upload time says it
+ * would overrun the budget, but the nearest chunk is always prepared so that the queue drains whatever the budget.
+ * With the multi-draw, the vertices go to the batch slot matching the chunk's slot in the chunk grid.
+ */
+void ChunkManager::uploadChunks()
+{
+	// Collect the chunks waiting for their upload, nearest first
+	m_uploadQueue.clear();
+	m_chunkGrid.forEach([this](std::pair<int, int> coords, ChunkEntry& entry)
+	{
+		if (!entry.chunk.preparedToRender()) {
+			float dx = coords.first * m_chunkSize - m_pos.x;
+			float dz = coords.second * m_chunkSize - m_pos.z;
+			m_uploadQueue.emplace_back(dx * dx + dz * dz, coords);
 		}
+	});
+	if (m_uploadQueue.empty()) {
+		return;
 	}
+	std::sort(m_uploadQueue.begin(), m_uploadQueue.end(),
+			  [](const std::pair<float, std::pair<int, int>>& a, const std::pair<float, std::pair<int, int>>& b) { return a.first < b.first; });
+	m_uploadStats.maxBacklog = std::max(m_uploadStats.maxBacklog, m_uploadQueue.size());
+
+	// Upload the nearest chunks within the budget
+	auto start = std::chrono::steady_clock::now();
+	double elapsed = 0;
+	for (size_t i = 0; i < m_uploadQueue.size(); i++) {
+		if (i > 0 && m_uploadBudgetMs > 0 && elapsed + m_uploadCostMs > m_uploadBudgetMs) {
+			break;
+		}
 
-	// Lock the mutex
-	std::unique_lock<std::mutex> lck(m_mut);
+		// Prepare the chunk and set its sprite texture (no index buffer nor batch when only the textures are drawn)
+		std::pair<int, int> coords = m_uploadQueue[i].second;
+		ChunkEntry& entry = *m_chunkGrid.find(coords);
+		if (m_textureOnly) {
+			entry.chunk.prepareTexture(m_cmapPointer);
+		} else if (m_multiDraw) {
+			const ChunkIndexBuffer& indices = indexBuffer(entry.chunk.pointsPerSide());
+			if (!m_batch.created()) {
+				m_batch.create(m_chunkGrid.width() * m_chunkGrid.width(), entry.chunk.pointsPerSide(), indices);
+			}
+			entry.chunk.prepareToRender(m_cmapPointer, m_batch, m_chunkGrid.slotIndex(coords));
+		} else {
+			entry.chunk.prepareToRender(m_cmapPointer, indexBuffer(entry.chunk.pointsPerSide()));
+		}
+		entry.sprite.setTexture(*(entry.chunk.getTexture()));
 
-	// Add the 3D chunk to the chunk map
-	chunkMap.emplace(currentPair, tempChunk);
+		// Update the average upload time
+		double now = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_uploadCostMs = m_uploadStats.uploads == 0 ? now - elapsed : 0.9 * m_uploadCostMs + 0.1 * (now - elapsed);
+		elapsed = now;
+		m_uploadStats.uploads++;
+	}
 
-	// Print the coordinates of the added chunk
-	std::cout << "Chunk added at " << currentPair.first << ", " << currentPair.second << std::endl;
-	lck.unlock();
+	// Update the frame counters
+	m_uploadStats.frames++;
+	m_uploadStats.totalMs += elapsed;
+	m_uploadStats.maxFrameMs = std::max(m_uploadStats.maxFrameMs, elapsed);
+	if (m_uploadBudgetMs > 0 && elapsed > m_uploadBudgetMs) {
+		m_uploadStats.overBudget++;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @author Thomas Etheve
- * @brief Render chunks
- * @param shaderProgram : pointer to the shader program
+ * @brief Get the element buffer shared by the chunks with some number of points per side. It is built and uploaded the
+ * first time a chunk of this size is prepared. OpenGL thread only.
+ * @param pointsPerSide : number of points per chunk side
+ * @return the shared element buffer
  */
-void ChunkManager::renderChunks(GLuint* shaderProgramPointer)
+const ChunkIndexBuffer& ChunkManager::indexBuffer(unsigned int pointsPerSide)
 {
-	// Iterate through the chunk map
-	for (auto chunkIt = this->chunkMap.begin(); chunkIt != this->chunkMap.end(); chunkIt++)
+	auto found = m_indexBuffers.find(pointsPerSide);
+	if (found == m_indexBuffers.end()) {
+		found = m_indexBuffers.emplace(pointsPerSide, ChunkIndexBuffer()).first;
+		found->second.create(pointsPerSide);
+	}
+	return found->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Remove the chunks hidden behind nearer terrain from the draw queue. The occlusion horizon is raised by the
+ * tiles of the coarse height grids in order of their farthest distance, and each chunk is tested once every tile nearer
+ * than it is in. The horizon only holds if the terrain between the camera and the tiles is drawn, so the pass is
+ * skipped while the camera is not above the terrain or some chunk of the view distance is not prepared yet. A chunk
+ * drawn at a coarser level of detail can be drawn up to its level's height error below the heights of its tiles, so the
+ * tops of its tiles are lowered by that error before they raise the horizon.
+ * @param mvp : Model View Projection matrix of the frame, to find the level of detail of the occluding chunks
+ * @param viewport : size of the viewport (in pixels)
+ */
+void ChunkManager::cullOccluded(const glm::mat4& mvp, glm::vec2 viewport)
+{
+	// Collect the tiles of the chunks in the view distance, and check the camera is above the terrain under it
+	m_horizon.begin(m_pos);
+	m_occluders.clear();
+	size_t prepared = 0;
+	bool aboveTerrain = false;
+	bool underTerrain = false;
+	m_chunkGrid.forEach([this, &mvp, viewport, &prepared, &aboveTerrain, &underTerrain](std::pair<int, int> coords, ChunkEntry& entry)
 	{
-		// If the chunk is not prepared to render yet (buffers and 2d texture not generated), prepare it
-		if (!chunkIt->second.preparedToRender()) {
-			std::unique_lock<std::mutex> lck(m_mut);
+		if (!isWanted(coords) || !entry.chunk.preparedToRender()) {
+			return;
+		}
+		prepared++;
+
+		// Height error of the level the chunk is drawn at, the drawn surface may be that much under the tiles
+		unsigned int level = lodLevel(entry.chunk, mvp, viewport);
+		float drop = level > 0 ? entry.chunk.lodError(level) : 0.0f;
+		for (const auto& tile : entry.chunk.tileBounds()) {
+			if (m_pos.x >= tile.first.x && m_pos.x <= tile.second.x && m_pos.z >= tile.first.z && m_pos.z <= tile.second.z) {
+				aboveTerrain = aboveTerrain || m_pos.y > tile.second.y;
+				underTerrain = underTerrain || m_pos.y <= tile.second.y;
+			}
+			glm::vec3 drawnMin(tile.first.x, tile.first.y - drop, tile.first.z);
+			m_occluders.emplace_back(m_horizon.farDistance(tile.first, tile.second), std::make_pair(drawnMin, tile.second));
+		}
+	});
+	size_t side = 2 * static_cast<size_t>(m_viewDist) + 1;
+	if (!aboveTerrain || underTerrain || prepared < side * side) {
+		return;
+	}
 
-			// Prepare the chunk
-			chunkIt->second.prepareToRender(m_cmapPointer);
+	// Occluders by farthest distance, chunks by nearest distance
+	m_occludees.clear();
+	for (size_t i = 0; i < m_drawQueue.size(); i++) {
+		const Chunk& chunk = m_drawQueue[i].second->chunk;
+		m_occludees.emplace_back(m_horizon.nearDistance(chunk.boundsMin(), chunk.boundsMax()), i);
+	}
+	auto byDistance = [](const auto& a, const auto& b) { return a.first < b.first; };
+	std::sort(m_occluders.begin(), m_occluders.end(), byDistance);
+	std::sort(m_occludees.begin(), m_occludees.end(), byDistance);
+
+	// Sweep outwards, raising the horizon with the tiles nearer than each chunk before testing it
+	size_t next = 0;
+	for (auto& occludee : m_occludees) {
+		while (next < m_occluders.size() && m_occluders[next].first <= occludee.first) {
+			m_horizon.addOccluder(m_occluders[next].second.first, m_occluders[next].second.second);
+			next++;
+		}
+		const Chunk& chunk = m_drawQueue[occludee.second].second->chunk;
+		if (m_horizon.occluded(chunk.boundsMin(), chunk.boundsMax())) {
+			m_drawQueue[occludee.second].second = nullptr;
+			m_renderStats.occluded++;
+		}
+	}
 
-			// Add the chunk sprite to the sprite map
-			sf::Sprite sprite;										// Create the sprite
-			sprite.setTexture(*(chunkIt->second.getTexture()));		// Set the texture
-			this->chunkSprites.emplace(chunkIt->first, sprite);		// Add the pair (coords, sprite) to the map
+	// Remove the hidden chunks, keeping the others nearest first
+	m_drawQueue.erase(std::remove_if(m_drawQueue.begin(), m_drawQueue.end(),
+									 [](const std::pair<float, ChunkEntry*>& item) { return item.second == nullptr; }),
+					  m_drawQueue.end());
+}
 
-			lck.unlock();
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the coarsest level of detail of a chunk whose height error, projected at the nearest corner of the chunk's
+ * bounding box, stays under the screen-space error. A height difference projects to at most its size times the vertical
+ * axis column of the Model View Projection matrix over the clip w, which is the depth in perspective and 1 in
+ * orthographic projection.
+ * @param chunk : chunk with its level of detail errors
+ * @param mvp : Model View Projection matrix of the frame
+ * @param viewport : size of the viewport (in pixels)
+ * @return the level of detail (0 for the full resolution)
+ */
+unsigned int ChunkManager::lodLevel(const Chunk& chunk, const glm::mat4& mvp, glm::vec2 viewport) const
+{
+	if (m_lodPixels <= 0) {
+		return 0;
+	}
+
+	// Smallest clip w over the corners of the bounding box (w is linear), full resolution if the box reaches the camera
+	glm::vec4 wRow(mvp[0][3], mvp[1][3], mvp[2][3], mvp[3][3]);
+	float w = std::numeric_limits<float>::max();
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec3 point((corner & 1) ? chunk.boundsMax().x : chunk.boundsMin().x,
+						(corner & 2) ? chunk.boundsMax().y : chunk.boundsMin().y,
+						(corner & 4) ? chunk.boundsMax().z : chunk.boundsMin().z);
+		w = std::min(w, glm::dot(wRow, glm::vec4(point, 1)));
+	}
+	if (w <= 0) {
+		return 0;
+	}
+
+	// Pixels per meter of height at that depth, then the coarsest level under the error (the errors grow with the level)
+	float pixelsPerMeter = glm::length(glm::vec2(mvp[1][0] * viewport.x, mvp[1][1] * viewport.y)) / (2 * w);
+	unsigned int level = 0;
+	while (level + 1 < chunk.lodLevels() && chunk.lodError(level + 1) * pixelsPerMeter <= m_lodPixels) {
+		level++;
+	}
+	return level;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Render chunks. The chunks whose bounding box is out of the view frustum or under the occlusion horizon are
+ * skipped, and the others are drawn nearest first so that the depth test rejects the fragments hidden behind them
+ * early. The shader program and the primitive restart are set once for all the chunks, which are then drawn with one
+ * call each, or all with one multi-draw call (in the same order), at the level of detail of their distance.
+ * @param shaderProgram : pointer to the shader program
+ * @param mvp : Model View Projection matrix of the frame
+ * @param viewport : size of the viewport (in pixels)
+ */
+void ChunkManager::renderChunks(GLuint* shaderProgramPointer, const glm::mat4& mvp, glm::vec2 viewport)
+{
+	// Prepare the new chunks within the upload budget, the others wait for the next frames
+	uploadChunks();
+	if (m_textureOnly) {
+		return;
+	}
+
+	// Collect the chunks prepared to render in the view frustum, nearest first
+	Frustum frustum(mvp);
+	m_drawQueue.clear();
+	m_chunkGrid.forEach([this, &frustum](std::pair<int, int>, ChunkEntry& entry)
+	{
+		if (!entry.chunk.preparedToRender()) {
+			return;
+		}
+		if (!frustum.intersects(entry.chunk.boundsMin(), entry.chunk.boundsMax())) {
+			m_renderStats.culled++;
+			return;
 		}
+		glm::vec3 offset = 0.5f * (entry.chunk.boundsMin() + entry.chunk.boundsMax()) - m_pos;
+		m_drawQueue.emplace_back(glm::dot(offset, offset), &entry);
+	});
+	std::sort(m_drawQueue.begin(), m_drawQueue.end(),
+			  [](const std::pair<float, ChunkEntry*>& a, const std::pair<float, ChunkEntry*>& b) { return a.first < b.first; });
+
+	// Skip the chunks hidden behind nearer terrain
+	if (m_occlusion) {
+		cullOccluded(mvp, viewport);
+	}
 
-		// Render the chunk
-		chunkIt->second.renderChunk(shaderProgramPointer);
+	// State shared by all the chunks: the shader program, the grid of the chunks (the vertices only hold their height),
+	// the color map lookup table, and the restart index that ends the strips of the shared EBOs
+	glUseProgram(*shaderProgramPointer);
+	GLint originLocation = glGetUniformLocation(*shaderProgramPointer, "chunkOrigin");
+	glUniform1f(glGetUniformLocation(*shaderProgramPointer, "chunkSpacing"), static_cast<float>(m_resolution));
+	if (!m_drawQueue.empty()) {
+		glUniform1i(glGetUniformLocation(*shaderProgramPointer, "chunkPoints"), m_drawQueue.front().second->chunk.pointsPerSide());
+	}
+	glUniform1i(glGetUniformLocation(*shaderProgramPointer, "batchSlotVertices"), m_multiDraw ? m_batch.slotVertices() : 0);
+	glUniform1i(glGetUniformLocation(*shaderProgramPointer, "slotOrigins"), 0);
+	m_cmapPointer->use(*shaderProgramPointer);
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(CHUNK_RESTART_INDEX);
+
+	if (m_multiDraw) {
+		// Gather the slots of the chunks, and draw them in one call
+		m_batch.clear();
+		for (auto& item : m_drawQueue) {
+			const ChunkIndexBuffer& indices = indexBuffer(item.second->chunk.pointsPerSide());
+			unsigned int level = lodLevel(item.second->chunk, mvp, viewport);
+			m_batch.add(item.second->chunk.batchSlot(), level);
+			m_renderStats.triangles += indices.triangles(level);
+			m_renderStats.coarseChunks += level > 0 ? 1 : 0;
+		}
+		size_t drawn = m_batch.draw(GL_TEXTURE0);
+		m_renderStats.drawCalls += drawn > 0 ? 1 : 0;
+		m_renderStats.chunksDrawn += drawn;
+	} else {
+		// One call per chunk
+		for (auto& item : m_drawQueue) {
+			const ChunkIndexBuffer& indices = indexBuffer(item.second->chunk.pointsPerSide());
+			unsigned int level = lodLevel(item.second->chunk, mvp, viewport);
+			item.second->chunk.renderChunk(indices, level, originLocation);
+			m_renderStats.triangles += indices.triangles(level);
+			m_renderStats.coarseChunks += level > 0 ? 1 : 0;
+			m_renderStats.drawCalls++;
+			m_renderStats.chunksDrawn++;
+		}
 	}
+
+	// Restore the state
+	glBindVertexArray(0);
+	glDisable(GL_PRIMITIVE_RESTART);
+	m_renderStats.frames++;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -221,19 +794,22 @@ void ChunkManager::renderChunks(GLuint* shaderProgramPointer)
  */
 void ChunkManager::drawChunks(sf::RenderWindow* window)
 {
-	// Loop through the sprites
-	for(auto elementIt = this->chunkSprites.begin(); elementIt != this->chunkSprites.end(); ++elementIt)
+	// Loop through the chunks that have a sprite
+	m_chunkGrid.forEach([window](std::pair<int, int> chunkCoords, ChunkEntry& entry)
 	{
+		if (!entry.chunk.preparedToRender()) {
+			return;
+		}
+
 		// Get some data from the current element
-		std::pair<int,int> chunkCoords = elementIt->first;					// Chunk Coord in the Chunk map cell grid
-		sf::FloatRect spriteBounds = elementIt->second.getGlobalBounds();	// Get the sprite bounds
+		sf::FloatRect spriteBounds = entry.sprite.getGlobalBounds();	// Get the sprite bounds
 		
-		// Set the sprite position
-		elementIt->second.setPosition(window->getSize().x/2 + (-0.5f + chunkCoords.first)*spriteBounds.width,  window->getSize().y/2  + (-0.5f + chunkCoords.second)*spriteBounds.height);
+		// Set the sprite position (chunk coords in the chunk grid)
+		entry.sprite.setPosition(window->getSize().x/2 + (-0.5f + chunkCoords.first)*spriteBounds.width,  window->getSize().y/2  + (-0.5f + chunkCoords.second)*spriteBounds.height);
 		
 		// Draw the sprite
-		window->draw(elementIt->second);
-	}
+		window->draw(entry.sprite);
+	});
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -243,7 +819,46 @@ void ChunkManager::drawChunks(sf::RenderWindow* window)
  */
 ChunkManager::~ChunkManager()
 {
-	for (auto& t : threadVector) {
-		t.join();
+	// The thread pool drops the queued chunks and joins its workers when it is destroyed
+
+	// Save the live and the cached chunks so that the next session over the same terrain starts warm
+	if (m_store) {
+		m_chunkGrid.forEach([this](std::pair<int, int> coords, ChunkEntry& entry) { saveChunk(coords, entry.chunk); });
+		m_cache.forEach([this](std::pair<int, int> coords, ChunkEntry& entry) { saveChunk(coords, entry.chunk); });
+		m_store->flush();
+
+		ChunkStoreStats storeStats = m_store->stats();
+		std::cout << "Chunk store hits: " << storeStats.hits << ", misses: " << storeStats.misses
+			<< ", writes: " << storeStats.writes << ", chunks stored: " << storeStats.entries << std::endl;
 	}
+
+	// Report the chunk cache counters
+	ChunkCacheStats cache = cacheStats();
+	std::cout << "Chunk cache hits: " << cache.hits << ", misses: " << cache.misses << ", evictions: " << cache.evictions
+		<< ", retained: " << cache.count << " chunks (" << cache.bytes / (1 << 20) << " MB)" << std::endl;
+
+	// Report the work saved by cancelling the chunks that went out of range
+	GenerationStats stats = generationStats();
+	std::cout << "Chunks generated: " << stats.generated << ", loaded: " << stats.loaded << ", cancelled while queued: " << stats.cancelledQueued
+		<< ", cancelled while running: " << stats.cancelledRunning << ", discarded: " << stats.discarded
+		<< ", rows saved: " << stats.rowsSaved << ", prefetched: " << stats.prefetched << std::endl;
+
+	// Report the churn of the chunk grid
+	StreamingStats streaming = streamingStats();
+	std::cout << "Center moves: " << streaming.centerMoves << " (" << streaming.reversals << " reversed), chunks loaded: "
+		<< streaming.loads << ", unloaded: " << streaming.unloads << ", reloaded: " << streaming.reloads << std::endl;
+
+	// Report the frame time spent uploading the chunks
+	UploadStats uploads = uploadStats();
+	std::cout << "Chunks uploaded: " << uploads.uploads << " in " << uploads.frames << " frames, "
+		<< (uploads.frames > 0 ? uploads.totalMs / uploads.frames : 0.0) << " ms per frame (max " << uploads.maxFrameMs
+		<< " ms, " << uploads.overBudget << " frames over budget), max backlog: " << uploads.maxBacklog << std::endl;
+
+	// Report the draw calls per frame
+	RenderStats render = renderStats();
+	double frames = render.frames > 0 ? static_cast<double>(render.frames) : 1.0;
+	std::cout << "Frames rendered: " << render.frames << ", draw calls per frame: " << render.drawCalls / frames
+		<< ", chunks drawn per frame: " << render.chunksDrawn / frames << ", culled per frame: " << render.culled / frames
+		<< ", occluded per frame: " << render.occluded / frames << ", triangles per frame: " << render.triangles / frames
+		<< ", coarse chunks per frame: " << render.coarseChunks / frames << std::endl;
 }
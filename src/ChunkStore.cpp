@@ -0,0 +1,326 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Chunk Store class implementation file. The Chunk Store keeps the height data of chunks on disk, so that chunks dropped
+by the Chunk Manager are reloaded instead of generated again when the user comes back, in the same session or in a
+later one. Heights are appended to a data file. A memory-mapped index (open addressing hash table) maps the chunk
+coordinates and the hash of the terrain parameters to their position in the data file. Writes are done behind by a
+dedicated thread.
+*/
+
+// Standard libraries
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+// Header file
+#include "ChunkStore.hpp"
+
+namespace bip = boost::interprocess;
+namespace fs = std::filesystem;
+
+// Index file signature (the last character is the format version)
+static const char INDEX_MAGIC[8] = {'H', 'M', 'C', 'H', 'U', 'N', 'K', '1'};
+
+// Initial number of index entries
+static const uint64_t INITIAL_CAPACITY = 4096;
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Mix the key of a chunk into the starting position of its probe sequence (splitmix64 finalizer)
+ * @param paramsHash : hash of the terrain parameters
+ * @param coords : chunk coordinates
+ * @return the hash of the key
+ */
+static uint64_t keyHash(uint64_t paramsHash, std::pair<int, int> coords) {
+	uint64_t h = paramsHash ^ (static_cast<uint64_t>(static_cast<uint32_t>(coords.first)) << 32 | static_cast<uint32_t>(coords.second));
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+	return h ^ (h >> 31);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Constructor : opens or creates the store in a directory, for the chunks of one set of terrain parameters
+ * @param directory : directory of the store files, created if needed
+ * @param paramsHash : hash of the terrain parameters (TerrainParams::hash)
+ */
+ChunkStore::ChunkStore(const std::string& directory, uint64_t paramsHash)
+	: m_paramsHash(paramsHash), m_stop(false), m_writing(false), m_hits(0), m_misses(0), m_writes(0) {
+
+	// Create the directory and the files
+	fs::create_directories(directory);
+	m_indexPath = (fs::path(directory) / "chunks.idx").string();
+	m_dataPath = (fs::path(directory) / "chunks.dat").string();
+	openIndex(INITIAL_CAPACITY);
+
+	// Start the writer
+	m_writer = std::thread(&ChunkStore::writerLoop, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Map the index file and open the data file. If the index is missing or invalid, both are created empty.
+ * @param capacity : number of entries of a new index, a power of two
+ */
+void ChunkStore::openIndex(uint64_t capacity) {
+
+	// Map an existing index if it is valid
+	bool valid = false;
+	if (fs::exists(m_indexPath) && fs::file_size(m_indexPath) >= sizeof(IndexHeader)) {
+		m_indexFile = bip::file_mapping(m_indexPath.c_str(), bip::read_write);
+		m_indexRegion = bip::mapped_region(m_indexFile, bip::read_write);
+		uint64_t size = fs::file_size(m_indexPath);
+		uint64_t cap = header()->capacity;
+		valid = std::memcmp(header()->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 && cap > 0 && (cap & (cap - 1)) == 0 &&
+				size == sizeof(IndexHeader) + cap * sizeof(IndexEntry) && fs::exists(m_dataPath);
+	}
+
+	// Otherwise create an empty index and an empty data file
+	if (!valid) {
+		m_indexRegion = bip::mapped_region();
+		m_indexFile = bip::file_mapping();
+		std::ofstream(m_indexPath, std::ios::binary | std::ios::trunc).close();
+		fs::resize_file(m_indexPath, sizeof(IndexHeader) + capacity * sizeof(IndexEntry));
+		std::ofstream(m_dataPath, std::ios::binary | std::ios::trunc).close();
+
+		m_indexFile = bip::file_mapping(m_indexPath.c_str(), bip::read_write);
+		m_indexRegion = bip::mapped_region(m_indexFile, bip::read_write);
+		std::memcpy(header()->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+		header()->capacity = capacity;
+		header()->count = 0;
+	}
+
+	// Open the data file for reading and appending
+	m_data.open(m_dataPath, std::ios::in | std::ios::out | std::ios::binary);
+	if (!m_data.is_open()) {
+		throw std::runtime_error("cannot open " + m_dataPath);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Find the entry of a chunk, or the free entry where it would go (linear probing). The index is never more
+ * than half full, so the probe always ends.
+ * @param coords : chunk coordinates
+ * @return the entry
+ */
+ChunkStore::IndexEntry* ChunkStore::findEntry(std::pair<int, int> coords) const {
+	uint64_t mask = header()->capacity - 1;
+	for (uint64_t i = keyHash(m_paramsHash, coords) & mask; ; i = (i + 1) & mask) {
+		IndexEntry* entry = entries() + i;
+		if (!entry->used || (entry->paramsHash == m_paramsHash && entry->x == coords.first && entry->z == coords.second)) {
+			return entry;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Double the capacity of the index and insert the entries again
+ */
+void ChunkStore::growIndex() {
+
+	// Keep a copy of the used entries
+	std::vector<IndexEntry> used;
+	for (uint64_t i = 0; i < header()->capacity; i++) {
+		if (entries()[i].used) {
+			used.push_back(entries()[i]);
+		}
+	}
+	uint64_t capacity = header()->capacity * 2;
+
+	// Remap the index with the new size and clear it
+	m_indexRegion = bip::mapped_region();
+	m_indexFile = bip::file_mapping();
+	fs::resize_file(m_indexPath, sizeof(IndexHeader) + capacity * sizeof(IndexEntry));
+	m_indexFile = bip::file_mapping(m_indexPath.c_str(), bip::read_write);
+	m_indexRegion = bip::mapped_region(m_indexFile, bip::read_write);
+	std::memset(entries(), 0, capacity * sizeof(IndexEntry));
+	header()->capacity = capacity;
+
+	// Insert the entries again (findEntry only looks at the probe sequence, so other parameter hashes keep their slot)
+	uint64_t mask = capacity - 1;
+	for (const IndexEntry& entry : used) {
+		uint64_t i = keyHash(entry.paramsHash, std::pair<int, int>(entry.x, entry.z)) & mask;
+		while (entries()[i].used) {
+			i = (i + 1) & mask;
+		}
+		entries()[i] = entry;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Load the heights of a chunk. Safe to call from several threads.
+ * @param coords : chunk coordinates
+ * @param heights : receives the heights, row-major
+ * @return true if the chunk was in the store
+ */
+bool ChunkStore::load(std::pair<int, int> coords, std::vector<float>& heights) {
+	std::unique_lock<std::mutex> lck(m_mut);
+
+	// Look up the chunk
+	IndexEntry* entry = findEntry(coords);
+	if (!entry->used) {
+		m_misses++;
+		return false;
+	}
+
+	// Read its heights
+	heights.resize(entry->count);
+	m_data.clear();
+	m_data.seekg(entry->offset);
+	m_data.read(reinterpret_cast<char*>(heights.data()), entry->count * sizeof(float));
+	if (!m_data) {
+		// Truncated data file: treat it as a miss, the chunk is generated again
+		m_data.clear();
+		m_misses++;
+		return false;
+	}
+	m_hits++;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Check whether a chunk is in the store
+ * @param coords : chunk coordinates
+ * @return true if the chunk is in the store
+ */
+bool ChunkStore::contains(std::pair<int, int> coords) {
+	std::unique_lock<std::mutex> lck(m_mut);
+	return findEntry(coords)->used;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Queue the heights of a chunk to be written by the writer thread
+ * @param coords : chunk coordinates
+ * @param heights : heights of the chunk, row-major
+ */
+void ChunkStore::storeAsync(std::pair<int, int> coords, std::vector<float>&& heights) {
+	std::unique_lock<std::mutex> lck(m_pendingMut);
+	m_pending.push_back(PendingWrite{coords, std::move(heights)});
+	lck.unlock();
+	m_pendingCv.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Write a chunk to the data file, then publish it in the index. Chunks already in the store are skipped.
+ * @param pending : chunk to write
+ */
+void ChunkStore::write(const PendingWrite& pending) {
+	std::unique_lock<std::mutex> lck(m_mut);
+
+	// Keep the index at most half full
+	IndexEntry* entry = findEntry(pending.coords);
+	if (entry->used) {
+		return;
+	}
+	if (2 * (header()->count + 1) > header()->capacity) {
+		growIndex();
+		entry = findEntry(pending.coords);
+	}
+
+	// Append the heights to the data file
+	m_data.clear();
+	m_data.seekp(0, std::ios::end);
+	uint64_t offset = static_cast<uint64_t>(m_data.tellp());
+	m_data.write(reinterpret_cast<const char*>(pending.heights.data()), pending.heights.size() * sizeof(float));
+	m_data.flush();
+	if (!m_data) {
+		std::cerr << "Chunk store: cannot write to " << m_dataPath << std::endl;
+		m_data.clear();
+		return;
+	}
+
+	// Publish the entry once its data is written
+	entry->paramsHash = m_paramsHash;
+	entry->x = pending.coords.first;
+	entry->z = pending.coords.second;
+	entry->offset = offset;
+	entry->count = static_cast<uint32_t>(pending.heights.size());
+	entry->used = 1;
+	header()->count++;
+	m_writes++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Main loop of the writer thread: write the queued chunks in order, until the store is destroyed and the
+ * queue is empty
+ */
+void ChunkStore::writerLoop() {
+	std::unique_lock<std::mutex> lck(m_pendingMut);
+	while (true) {
+		m_pendingCv.wait(lck, [this] { return m_stop || !m_pending.empty(); });
+		if (m_pending.empty()) {
+			return; // Stopped and nothing left to write
+		}
+
+		// Write the oldest chunk without holding the queue lock
+		PendingWrite pending = std::move(m_pending.front());
+		m_pending.pop_front();
+		m_writing = true;
+		lck.unlock();
+		write(pending);
+		lck.lock();
+		m_writing = false;
+		m_pendingCv.notify_all();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Wait until every queued chunk is written
+ */
+void ChunkStore::flush() {
+	std::unique_lock<std::mutex> lck(m_pendingMut);
+	m_pendingCv.wait(lck, [this] { return m_pending.empty() && !m_writing; });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Get the store counters
+ * @return the counters
+ */
+ChunkStoreStats ChunkStore::stats() {
+	ChunkStoreStats stats;
+	stats.hits = m_hits.load();
+	stats.misses = m_misses.load();
+	stats.writes = m_writes.load();
+	std::unique_lock<std::mutex> lck(m_mut);
+	stats.entries = header()->count;
+	return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Destructor : writes the queued chunks, stops the writer thread and flushes the index to disk
+ */
+ChunkStore::~ChunkStore() {
+	std::unique_lock<std::mutex> lck(m_pendingMut);
+	m_stop = true;
+	lck.unlock();
+	m_pendingCv.notify_all();
+	m_writer.join();
+	m_indexRegion.flush();
+}
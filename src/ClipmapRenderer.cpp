@@ -0,0 +1,372 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Clipmap Renderer class implementation file. The geometry clipmap draws the terrain as nested square rings of one fixed
+grid mesh around the camera, each level twice as coarse as the one inside it. The heights of each level live in a layer
+of an array texture addressed toroidally, filled by the chunks' noise generator, so that when the camera moves only the
+newly exposed rows and columns are sampled and uploaded, a few rows per frame within a time budget. The grid positions come from gl_VertexID, the mesh itself is
+only an index buffer, and the heights are colored by the color map's lookup table.
+*/
+
+// Standard libraries
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+
+// Header files
+#include "ClipmapRenderer.hpp"
+#include "ChunkIndices.hpp"                     // Strip indices of the finest level and restart index
+#include <common/shader.hpp>                    // Load the shaders
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Build the triangle strip indices of a level's ring: the m x m grid (vertex index = row * m + column) without
+ * the square hole covered by the finer level. One strip per row of quads and per side of the hole, separated by
+ * CHUNK_RESTART_INDEX, with the same winding as the chunks.
+ * @param size : m, the number of points per side
+ * @param holeRow : first row of quads of the hole
+ * @param holeCol : first column of quads of the hole
+ * @param holeQuads : number of quads per side of the hole
+ * @return the indices of the triangle strips
+ */
+static std::vector<unsigned int> ringStripIndices(unsigned int size, unsigned int holeRow, unsigned int holeCol, unsigned int holeQuads)
+{
+	std::vector<unsigned int> indices;
+	unsigned int quads = size - 1;
+	auto strip = [&indices, size](unsigned int row, unsigned int firstCol, unsigned int lastCol) {
+		if (firstCol >= lastCol) {
+			return;
+		}
+		if (!indices.empty()) {
+			indices.push_back(CHUNK_RESTART_INDEX);
+		}
+		for (unsigned int col = firstCol; col <= lastCol; col++) {
+			indices.push_back(row * size + col);
+			indices.push_back((row + 1) * size + col);
+		}
+	};
+	for (unsigned int row = 0; row < quads; row++) {
+		if (row >= holeRow && row < holeRow + holeQuads) {
+			strip(row, 0, holeCol);
+			strip(row, holeCol + holeQuads, quads);
+		} else {
+			strip(row, 0, quads);
+		}
+	}
+	return indices;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Constructor. Compiles the shader program, builds the index buffer of the full grid and of the 4 ring variants,
+ * and allocates the level textures. The textures are filled in by the first update.
+ * @param params : validated terrain parameters
+ * @param cmapPointer : color map, its lookup table texture must be created
+ * @param options : number of levels, points per side of a level's grid and time budget of the updates
+ */
+ClipmapRenderer::ClipmapRenderer(const TerrainParams& params, const ColorMap* cmapPointer, const ClipmapOptions& options)
+	: m_generator(params), m_cmap(cmapPointer), m_resolution(params.resolution), m_levels(options.levels),
+	  m_size(static_cast<int>(options.gridSize)), m_updateBudgetMs(options.updateBudgetMs), m_origins(options.levels),
+	  m_pending(options.levels)
+{
+	if (m_levels == 0 || m_size < 9 || (m_size - 1) % 4 != 0) {
+		throw std::invalid_argument("the clipmap needs at least one level and 4k + 1 points per side (k >= 2)");
+	}
+
+	// Shader program
+	m_program = LoadShaders("Clipmap.vertexshader", "StandardShading.fragmentshader");
+	m_mvpLocation = glGetUniformLocation(m_program, "MVP");
+	m_originLocation = glGetUniformLocation(m_program, "origin");
+	m_spacingLocation = glGetUniformLocation(m_program, "spacing");
+	m_levelLocation = glGetUniformLocation(m_program, "level");
+	m_sizeLocation = glGetUniformLocation(m_program, "gridSize");
+	m_morphLocation = glGetUniformLocation(m_program, "morphBorder");
+	glUseProgram(m_program);
+	glUniform1i(glGetUniformLocation(m_program, "heights"), 0);
+	glUseProgram(0);
+
+	// Full grid of the finest level, then the rings with their hole at offset (m - 1) / 4 + (0 or 1) along each axis
+	unsigned int size = static_cast<unsigned int>(m_size);
+	unsigned int holeQuads = (size - 1) / 2;
+	std::vector<unsigned int> indices;
+	for (int variant = 0; variant < 5; variant++) {
+		std::vector<unsigned int> mesh = variant == 0 ? bandedStripIndices(size)
+			: ringStripIndices(size, (size - 1) / 4 + ((variant - 1) & 1), (size - 1) / 4 + ((variant - 1) >> 1), holeQuads);
+		m_offsets[variant] = indices.size();
+		m_counts[variant] = static_cast<GLsizei>(mesh.size());
+		m_triangles[variant] = stripTriangleCount(mesh);
+		indices.insert(indices.end(), mesh.begin(), mesh.end());
+	}
+	m_vertexArray.create();
+	glBindVertexArray(m_vertexArray.get());
+	m_indexBuffer.create();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer.get());
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	// Level heights, one layer per level
+	m_heights.create();
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_heights.get());
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, m_size, m_size, m_levels, 0, GL_RED, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the grid coordinates of the first point of a level centered on a position. The origin is snapped to the
+ * points of the next coarser level, so that the level's border lies on that level's vertices.
+ * @param level : level
+ * @param position : camera position
+ * @return the grid coordinates of the first point (in points of the level, even)
+ */
+glm::ivec2 ClipmapRenderer::levelOrigin(unsigned int level, glm::vec3 position) const
+{
+	double coarseSpacing = 2 * m_resolution * (1u << level);
+	int half = (m_size - 1) / 2;
+	return glm::ivec2(2 * static_cast<int>(std::floor(position.x / coarseSpacing)) - half,
+					  2 * static_cast<int>(std::floor(position.z / coarseSpacing)) - half);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Center the levels on the camera position. A level that moved by less than its width only queues
+ * the rows and columns that entered it, the others are kept in place in the toroidal textures. The queued rows are then
+ * sampled within the time budget, so a jump spreads the refill of the levels over several frames.
+ * @param position : camera position
+ */
+void ClipmapRenderer::update(glm::vec3 position)
+{
+	for (unsigned int level = 0; level < m_levels; level++) {
+		glm::ivec2 origin = levelOrigin(level, position);
+		glm::ivec2 previous = m_origins[level];
+		glm::ivec2 shift = origin - previous;
+		m_origins[level] = origin;
+
+		// Refill the whole level the first time or after a jump
+		if (!m_placed || std::abs(shift.x) >= m_size || std::abs(shift.y) >= m_size) {
+			m_pending[level].clear();
+			queueRegion(level, origin.x, origin.y, m_size, m_size);
+			continue;
+		}
+
+		// Rows (constant x) that entered the level, then columns (constant z)
+		if (shift.x > 0) {
+			queueRegion(level, previous.x + m_size, origin.y, shift.x, m_size);
+		} else if (shift.x < 0) {
+			queueRegion(level, origin.x, origin.y, -shift.x, m_size);
+		}
+		if (shift.y > 0) {
+			queueRegion(level, origin.x, previous.y + m_size, m_size, shift.y);
+		} else if (shift.y < 0) {
+			queueRegion(level, origin.x, origin.y, m_size, -shift.y);
+		}
+	}
+	m_placed = true;
+
+	fillPending();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Queue a region of a level's grid to be sampled. When the queued regions would cover as many points as the
+ * level, they are replaced by one region with the whole level.
+ * @param level : level
+ * @param x0 : grid x coordinate of the first row
+ * @param z0 : grid z coordinate of the first column
+ * @param rows : number of rows (along x), at most m
+ * @param cols : number of columns (along z), at most m
+ */
+void ClipmapRenderer::queueRegion(unsigned int level, int x0, int z0, int rows, int cols)
+{
+	std::deque<glm::ivec4>& pending = m_pending[level];
+	pending.emplace_back(x0, z0, rows, cols);
+
+	size_t queued = 0;
+	for (const glm::ivec4& region : pending) {
+		queued += static_cast<size_t>(region.z) * region.w;
+	}
+	if (pending.size() > 1 && queued >= static_cast<size_t>(m_size) * m_size) {
+		pending.clear();
+		pending.emplace_back(m_origins[level].x, m_origins[level].y, m_size, m_size);
+	}
+	if (pending.size() == 1 && pending.front().z == m_size && pending.front().w == m_size) {
+		m_stats.fullUpdates++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Sample and upload the queued regions one row at a time, finest level first, until the time budget is spent
+ * (at least one row per frame). The regions are clipped to the current grid of their level: the points that left it
+ * are skipped, and those that came back were queued again by update.
+ */
+void ClipmapRenderer::fillPending()
+{
+	auto start = std::chrono::steady_clock::now();
+	bool sampled = false;
+	for (unsigned int level = 0; level < m_levels; level++) {
+		std::deque<glm::ivec4>& pending = m_pending[level];
+		glm::ivec2 origin = m_origins[level];
+		while (!pending.empty()) {
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (sampled && m_updateBudgetMs > 0 && elapsed >= m_updateBudgetMs) {
+				m_stats.deferredFrames++;
+				return;
+			}
+
+			// Clip the first region to the level's grid
+			glm::ivec4& region = pending.front();
+			int x0 = std::max(region.x, origin.x);
+			int x1 = std::min(region.x + region.z, origin.x + m_size);
+			int z0 = std::max(region.y, origin.y);
+			int z1 = std::min(region.y + region.w, origin.y + m_size);
+			if (x0 >= x1 || z0 >= z1) {
+				pending.pop_front();
+				continue;
+			}
+
+			// Sample its first row, and keep the rest for later
+			fillRegion(level, x0, z0, 1, z1 - z0);
+			sampled = true;
+			region = glm::ivec4(x0 + 1, z0, x1 - x0 - 1, z1 - z0);
+			if (region.z == 0) {
+				pending.pop_front();
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Sample and upload a region of a level's grid, split in up to 4 parts where it wraps around the textures
+ * @param level : level
+ * @param x0 : grid x coordinate of the first row
+ * @param z0 : grid z coordinate of the first column
+ * @param rows : number of rows (along x), at most m
+ * @param cols : number of columns (along z), at most m
+ */
+void ClipmapRenderer::fillRegion(unsigned int level, int x0, int z0, int rows, int cols)
+{
+	int rowsBeforeWrap = std::min(rows, m_size - wrap(x0));
+	int colsBeforeWrap = std::min(cols, m_size - wrap(z0));
+	fillTexels(level, x0, z0, rowsBeforeWrap, colsBeforeWrap);
+	fillTexels(level, x0 + rowsBeforeWrap, z0, rows - rowsBeforeWrap, colsBeforeWrap);
+	fillTexels(level, x0, z0 + colsBeforeWrap, rowsBeforeWrap, cols - colsBeforeWrap);
+	fillTexels(level, x0 + rowsBeforeWrap, z0 + colsBeforeWrap, rows - rowsBeforeWrap, cols - colsBeforeWrap);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Sample the heights of a region of a level's grid that does not wrap around the texture, and upload them to the
+ * level's layer. The rows of the region are the texture rows (x), its columns the texture columns (z).
+ * @param level : level
+ * @param x0 : grid x coordinate of the first row
+ * @param z0 : grid z coordinate of the first column
+ * @param rows : number of rows (along x)
+ * @param cols : number of columns (along z)
+ */
+void ClipmapRenderer::fillTexels(unsigned int level, int x0, int z0, int rows, int cols)
+{
+	if (rows <= 0 || cols <= 0) {
+		return;
+	}
+
+	// Sample the heights with the chunks' noise
+	double spacing = m_resolution * (1u << level);
+	size_t count = static_cast<size_t>(rows) * cols;
+	m_heightSamples.resize(count);
+	m_generator.sampleGrid(x0 * spacing, z0 * spacing, spacing, rows, cols, m_heightSamples.data());
+
+	// Upload them at their toroidal place
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_heights.get());
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, wrap(z0), wrap(x0), level, cols, rows, 1, GL_RED, GL_FLOAT, m_heightSamples.data());
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	m_stats.texelsUpdated += count;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Draw the levels, finest first: the full grid for the finest filled level, then each level's ring around the
+ * finer level, up to the first level with rows left to sample. The ring's hole is at one of 4 offsets depending on how
+ * the finer level's origin is snapped. The border of every level but the last drawn is bent onto the coarser level's
+ * edges in the vertex shader, so that the levels meet without cracks.
+ * @param mvp : Model View Projection matrix of the frame
+ */
+void ClipmapRenderer::render(const glm::mat4& mvp)
+{
+	// State shared by all the levels
+	glUseProgram(m_program);
+	glUniformMatrix4fv(m_mvpLocation, 1, GL_FALSE, &mvp[0][0]);
+	glUniform1i(m_sizeLocation, m_size);
+	m_cmap->use(m_program);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_heights.get());
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(CHUNK_RESTART_INDEX);
+	glBindVertexArray(m_vertexArray.get());
+
+	// Levels filled in: after a jump the finest ones are refilled first, the coarser ones appear in the next frames
+	unsigned int first = 0;
+	while (first < m_levels && !m_pending[first].empty()) {
+		first++;
+	}
+	unsigned int last = first;
+	while (last < m_levels && m_pending[last].empty()) {
+		last++;
+	}
+
+	int quarter = (m_size - 1) / 4;
+	for (unsigned int level = first; level < last; level++) {
+		// Mesh of the level: the full grid, or the ring whose hole matches the finer level's origin
+		int variant = 0;
+		if (level > first) {
+			glm::ivec2 hole = m_origins[level - 1] / 2 - m_origins[level];
+			variant = 1 + (hole.x - quarter) + 2 * (hole.y - quarter);
+		}
+
+		glUniform2i(m_originLocation, m_origins[level].x, m_origins[level].y);
+		glUniform1f(m_spacingLocation, static_cast<float>(m_resolution * (1u << level)));
+		glUniform1i(m_levelLocation, static_cast<int>(level));
+		glUniform1i(m_morphLocation, level + 1 < last ? 1 : 0);
+		glDrawElements(GL_TRIANGLE_STRIP, m_counts[variant], GL_UNSIGNED_INT,
+					   reinterpret_cast<const void*>(m_offsets[variant] * sizeof(unsigned int)));
+		m_stats.triangles += m_triangles[variant];
+	}
+	m_stats.frames++;
+
+	// Restore the state
+	glBindVertexArray(0);
+	glDisable(GL_PRIMITIVE_RESTART);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Destructor. Deletes the shader program and reports the clipmap counters.
+ */
+ClipmapRenderer::~ClipmapRenderer()
+{
+	glDeleteProgram(m_program);
+
+	double frames = m_stats.frames > 0 ? static_cast<double>(m_stats.frames) : 1.0;
+	std::cout << "Clipmap frames: " << m_stats.frames << ", texels updated: " << m_stats.texelsUpdated
+		<< " (" << m_stats.fullUpdates << " full level updates, " << m_stats.deferredFrames << " frames over budget), triangles per frame: "
+		<< m_stats.triangles / frames << std::endl;
+}
@@ -5,6 +5,7 @@ Last Date Modified: 11/27/2024
 
 Description:
 This file is the cpp implementation file of the ColorMap class. It contains the methods to construct the class, and color the vertices of the terrain.
+The gradient is baked into a 1D texture (lookup table) sampled by height in the fragment shader, so that the vertices only carry their height.
 */
 
 #include "ColorMap.hpp"
@@ -36,98 +37,152 @@ ColorMap::ColorMap(ColorMapType type, float minAlt, float maxAlt)
 
 /**
  * @author Thomas Etheve
- * @brief Get the color vector corresponding to the vertices vector
- * @param vertices : vector of vertices
+ * @brief Get the color of one altitude with the colormap type
+ * @param y : altitude
+ * @return the color
  */
-
-std::vector<glm::vec3> ColorMap::getColorVector(const std::vector<glm::vec3>& vertices)
+glm::vec3 ColorMap::getColor(float y) const
 {
-    // Create the color vector to return
-    std::vector<glm::vec3> colors;
-
     // Use the appropriate function depending on the colormap type
     switch (this->type)
     {
         // Color with Earth Gist colormap
         case ColorMapType::GIST_EARTH:
-            this->getEarthLevels(vertices, colors);
-            break;
+            return this->earthLevelColor(y);
 
         // Color with Monochrome levels colormap
         case ColorMapType::GRAY_SCALE:
-            this->getGrayScale(vertices, colors);
-            break;
+        default:
+            return this->grayScaleColor(y);
     }
-
-    // Return the color vector
-    return colors;
 }
 
 /**
  * @author Thomas Etheve
- * @brief Get the color vector corresponding to monorchrome levels
- * @param vertices : vector of vertices
- * @param colors : vector of colors
+ * @brief Get the monochrome level of one altitude
+ * @param y : altitude
+ * @return the color
  */
-
-void ColorMap::getGrayScale(const std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& colors)
+glm::vec3 ColorMap::grayScaleColor(float y) const
 {
     // Colors
     glm::vec3 black = glm::vec3(0, 0, 0);   // black
     glm::vec3 white = glm::vec3(1, 1, 1);   // white
 
-    // Associate a color to each vertex
-    for (const auto& vertex : vertices)
-    {
-        // Push back the color corresponding to the interpolation of the altitude value
-        colors.push_back(interpolateColors(this->minAlt, this->maxAlt, black, white, vertex.y));
-    }
+    // Interpolate the altitude value between black and white
+    return interpolateColors(this->minAlt, this->maxAlt, black, white, y);
 }
 
 /**
- * @brief Get the color vector corresponding to Earth Gist levels
- * @param vertices : vector of vertices
- * @param colors : vector of colors
+ * @author Thomas Etheve
+ * @brief Get the Earth Gist level of one altitude
+ * @param y : altitude
+ * @return the color
  */
-void ColorMap::getEarthLevels(const std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& colors)
+glm::vec3 ColorMap::earthLevelColor(float y) const
 {
     // Set the color steps 
     glm::vec3 darkBlue = glm::vec3(0.f, 0.f, 1.f);
-    glm::vec3 lightBlue = glm::vec3(0.06f, 0.89f, 1.f);
     glm::vec3 ligthGreen = glm::vec3(0.3f, 1.f, 0.3f);
     glm::vec3 brown = glm::vec3(0.5f,0.27f,0.11f);
     glm::vec3 gray = glm::vec3(0.5f, 0.5f, 0.5f);
     glm::vec3 white = glm::vec3(1.f, 1.f, 1.f);
 
-    // Associate a color to each vertex by successive altitude levels
-    for (const auto& vertex : vertices)
+    // Set dark blue to every point below the sea level
+    if (y < SEA_LEVEL*this->minAlt)
+    {
+        return darkBlue;
+    }
+    // Interpolate the colors between green and brown for altitudes in Land levels
+    else if (y < MAX_LAND*this->maxAlt)
+    {
+        return interpolateColors(SEA_LEVEL*this->minAlt, MAX_LAND*this->maxAlt, ligthGreen, brown, y);
+    }
+    // Interpolate the colors between brown and grey for altitudes in Mountain levels
+    else if (y < MAX_MOUNTAIN*this->maxAlt)
+    {
+        return interpolateColors(MAX_LAND*this->maxAlt, MAX_MOUNTAIN*this->maxAlt, brown, gray, y);
+    }
+    // Interpolate the colors between grey and white for altitudes in Snow levels
+    else if (y < MAX_ALT*this->maxAlt)
+    {
+        return interpolateColors(MAX_MOUNTAIN*this->maxAlt, MAX_ALT*this->maxAlt, gray, white, y);
+    }
+    // Set white color to every point higher than the snow level
+    return white;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Get the lookup table of the gradient: COLORMAP_LUT_SIZE colors sampled evenly from minAlt to maxAlt, the
+ * first and last ones exactly at minAlt and maxAlt
+ * @return the colors
+ */
+std::vector<glm::vec3> ColorMap::getLookupTable() const
+{
+    std::vector<glm::vec3> colors(COLORMAP_LUT_SIZE);
+    for (unsigned int i = 0; i < COLORMAP_LUT_SIZE; i++)
     {
-        // Set dark blue to every point below the sea level
-        if (vertex.y < SEA_LEVEL*this->minAlt)
-        {
-            colors.push_back(darkBlue);
-        }
-        // Interpolate the colors between green and brown for altitudes in Land levels
-        else if (vertex.y < MAX_LAND*this->maxAlt)
-        {
-            colors.push_back(interpolateColors(SEA_LEVEL*this->minAlt, MAX_LAND*this->maxAlt, ligthGreen, brown, vertex.y));
-        }
-        // Interpolate the colors between brown and grey for altitudes in Mountain levels
-        else if (vertex.y < MAX_MOUNTAIN*this->maxAlt)
-        {
-            colors.push_back(interpolateColors(MAX_LAND*this->maxAlt, MAX_MOUNTAIN*this->maxAlt, brown, gray, vertex.y));
-        }
-        // Interpolate the colors between grey and white for altitudes in Snow levels
-        else if (vertex.y < MAX_ALT*this->maxAlt)
-        {
-            colors.push_back(interpolateColors(MAX_MOUNTAIN*this->maxAlt, MAX_ALT*this->maxAlt, gray, white, vertex.y));
-        }
-        // Set white color to every point higher than the snow level
-        else if (vertex.y >= MAX_ALT*this->maxAlt)
-        {
-            colors.push_back(white);
-        }
+        colors[i] = this->getColor(this->minAlt + (this->maxAlt - this->minAlt) * i / (COLORMAP_LUT_SIZE - 1));
     }
+    return colors;
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Create the lookup table texture and bake the gradient into it. Must be called on the OpenGL thread.
+ */
+void ColorMap::createTexture()
+{
+    this->lut.create();
+    glBindTexture(GL_TEXTURE_1D, this->lut.get());
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    this->bakeTexture();
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Fill in the lookup table texture with the gradient of the current color map type
+ */
+void ColorMap::bakeTexture()
+{
+    std::vector<glm::vec3> colors = this->getLookupTable();
+    glBindTexture(GL_TEXTURE_1D, this->lut.get());
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, COLORMAP_LUT_SIZE, 0, GL_RGB, GL_FLOAT, colors.data());
+    glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Change the color map type. The 3D terrain only needs the lookup table to be baked again, the chunk workers color
+ * the 2D map of the chunks generated from now on with the new type. Must be called on the OpenGL thread.
+ * @param type : colormap type
+ */
+void ColorMap::setType(ColorMapType type)
+{
+    this->type = type;
+    if (this->lut)
+    {
+        this->bakeTexture();
+    }
+}
+
+/**
+ * @author Thomas Etheve
+ * @brief Bind the lookup table texture to COLORMAP_TEXTURE_UNIT and set the "colorMap" sampler and the "colorMapRange"
+ * altitudes of the shader program, which must be in use. Leaves GL_TEXTURE0 active.
+ * @param program : shader program in use
+ */
+void ColorMap::use(GLuint program) const
+{
+    glActiveTexture(GL_TEXTURE0 + COLORMAP_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_1D, this->lut.get());
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(program, "colorMap"), COLORMAP_TEXTURE_UNIT);
+    glUniform2f(glGetUniformLocation(program, "colorMapRange"), this->minAlt, this->maxAlt);
 }
 
 /**
@@ -138,7 +193,7 @@ void ColorMap::getEarthLevels(const std::vector<glm::vec3>& vertices, std::vecto
  * @param c2 : second color
  * @param y : y value
  */
-glm::vec3 ColorMap::interpolateColors(const float& y1, const float& y2, const glm::vec3& c1, const glm::vec3& c2, const float& y)
+glm::vec3 ColorMap::interpolateColors(const float& y1, const float& y2, const glm::vec3& c1, const glm::vec3& c2, const float& y) const
 {
     // Return the interpolated color using the linear interpolation formula
     return (c1 + ((y - y1)/(y2 - y1)) * (c2 - c1));
@@ -0,0 +1,173 @@
+/*
+Author: Thomas Etheve
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Horizon Culler class implementation file. The occlusion horizon is the elevation, for each azimuth around the camera,
+under which every view ray hits the terrain within some distance. It is raised front to back by the tiles of the
+chunks' coarse min/max height grids, and a chunk whose bounding box stays under the horizon everywhere is hidden behind
+nearer terrain. The camera must be above the terrain.
+*/
+
+// Standard libraries
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Header file
+#include "HorizonCuller.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Constructor
+ * @param bins : number of azimuth bins around the camera
+ */
+HorizonCuller::HorizonCuller(unsigned int bins) : m_eye(0, 0, 0), m_horizon(bins)
+{
+	begin(m_eye);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Lower the horizon under every ray, for a new frame
+ * @param eye : camera position, above the terrain
+ */
+void HorizonCuller::begin(glm::vec3 eye)
+{
+	m_eye = eye;
+	std::fill(m_horizon.begin(), m_horizon.end(), -std::numeric_limits<float>::infinity());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the azimuth range of the xz footprint of a box. The range is less than half a turn, so it is measured from
+ * the azimuth of the footprint's center, and may go past -pi or pi.
+ * @param boxMin : lowest corner of the box
+ * @param boxMax : highest corner of the box
+ * @param low : lowest azimuth (in radians)
+ * @param high : highest azimuth (in radians)
+ * @return false if the camera is over the footprint, which then covers every azimuth
+ */
+bool HorizonCuller::azimuthRange(const glm::vec3& boxMin, const glm::vec3& boxMax, float& low, float& high) const
+{
+	if (m_eye.x >= boxMin.x && m_eye.x <= boxMax.x && m_eye.z >= boxMin.z && m_eye.z <= boxMax.z) {
+		return false;
+	}
+
+	const float pi = 3.14159265358979f;
+	float center = std::atan2(0.5f * (boxMin.z + boxMax.z) - m_eye.z, 0.5f * (boxMin.x + boxMax.x) - m_eye.x);
+	low = 0;
+	high = 0;
+	for (int corner = 0; corner < 4; corner++) {
+		float x = (corner & 1) ? boxMax.x : boxMin.x;
+		float z = (corner & 2) ? boxMax.z : boxMin.z;
+		float offset = std::atan2(z - m_eye.z, x - m_eye.x) - center;
+		if (offset > pi) {
+			offset -= 2 * pi;
+		} else if (offset < -pi) {
+			offset += 2 * pi;
+		}
+		low = std::min(low, offset);
+		high = std::max(high, offset);
+	}
+	low += center + pi;
+	high += center + pi;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Raise the horizon with the top of a tile's min box, over the azimuth bins it fully covers. The slope is the
+ * lowest one of the top face, so that every bin has a point of the face at least that high.
+ * @param boxMin : lowest corner of the tile's box, the terrain over the tile is at least boxMin.y high
+ * @param boxMax : highest corner of the tile's box
+ */
+void HorizonCuller::addOccluder(const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	float low, high;
+	if (!azimuthRange(boxMin, boxMax, low, high)) {
+		return;
+	}
+
+	// Lowest slope of the top face: at its nearest point under the camera, at its farthest point above it
+	float height = boxMin.y - m_eye.y;
+	float slope = height / (height <= 0 ? nearDistance(boxMin, boxMax) : farDistance(boxMin, boxMax));
+
+	// Bins fully inside the azimuth range
+	int bins = static_cast<int>(m_horizon.size());
+	float binWidth = 2 * 3.14159265358979f / bins;
+	int first = static_cast<int>(std::ceil(low / binWidth));
+	int last = static_cast<int>(std::floor(high / binWidth)) - 1;
+	for (int bin = first; bin <= last; bin++) {
+		float& horizon = m_horizon[((bin % bins) + bins) % bins];
+		horizon = std::max(horizon, slope);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Check whether a box is under the horizon over every azimuth bin it touches. Only the occluders nearer than the
+ * box hide it, so they must have been added in order of their farthest distance, up to the box's nearest distance.
+ * @param boxMin : lowest corner of the box
+ * @param boxMax : highest corner of the box
+ * @return true if the box is hidden
+ */
+bool HorizonCuller::occluded(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	float low, high;
+	if (!azimuthRange(boxMin, boxMax, low, high)) {
+		return false;
+	}
+
+	// Highest slope of the box: at its nearest point above the camera, at its farthest point under it
+	float height = boxMax.y - m_eye.y;
+	float slope = height / (height >= 0 ? nearDistance(boxMin, boxMax) : farDistance(boxMin, boxMax));
+
+	// Bins touched by the azimuth range
+	int bins = static_cast<int>(m_horizon.size());
+	float binWidth = 2 * 3.14159265358979f / bins;
+	int first = static_cast<int>(std::floor(low / binWidth));
+	int last = static_cast<int>(std::floor(high / binWidth));
+	for (int bin = first; bin <= last; bin++) {
+		if (m_horizon[((bin % bins) + bins) % bins] <= slope) {
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the horizontal distance from the camera to the nearest point of the xz footprint of a box
+ * @param boxMin : lowest corner of the box
+ * @param boxMax : highest corner of the box
+ * @return the distance (0 if the camera is over the box)
+ */
+float HorizonCuller::nearDistance(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	float dx = std::max(std::max(boxMin.x - m_eye.x, m_eye.x - boxMax.x), 0.0f);
+	float dz = std::max(std::max(boxMin.z - m_eye.z, m_eye.z - boxMax.z), 0.0f);
+	return std::sqrt(dx * dx + dz * dz);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Thomas Etheve
+ * @brief Get the horizontal distance from the camera to the farthest point of the xz footprint of a box
+ * @param boxMin : lowest corner of the box
+ * @param boxMax : highest corner of the box
+ * @return the distance
+ */
+float HorizonCuller::farDistance(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	float dx = std::max(std::abs(boxMin.x - m_eye.x), std::abs(boxMax.x - m_eye.x));
+	float dz = std::max(std::abs(boxMin.z - m_eye.z), std::abs(boxMax.z - m_eye.z));
+	return std::sqrt(dx * dx + dz * dz);
+}
@@ -9,9 +9,14 @@ Description:
 #define _USE_MATH_DEFINES
 
 #include "Perlin.hpp"
+#include "PerlinKernel.hpp"
 #include <stddef.h>
 #include <cmath>
 
+#if PERLIN_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /**
  * @author Matt Luyten
  * @brief This implements a 32-bit LFSR that generates a pseudorandom sequence with a uniform distribution.
@@ -32,12 +37,96 @@ uint32_t lfsr(uint32_t seed, size_t shifts) {
     return seed;
 }
 
+/**
+ * @author Matt Luyten
+ * @brief Hashes a seed and an integer lattice position into a pseudorandom 32-bit number in constant time.
+ * Unlike lfsr, the cost does not depend on the distance of (x, y) from the origin.
+ *
+ * @param seed the noise seed
+ * @param x the x position on the lattice
+ * @param y the y position on the lattice
+ *
+ * @returns a pseudorandom number, identical for identical inputs
+ */
+uint32_t latticeHash(uint32_t seed, int x, int y) {
+    // Combine the inputs with large odd multipliers so that neighbouring positions differ in many bits
+    uint32_t h = seed ^ (static_cast<uint32_t>(x) * 0x8da6b343u) ^ (static_cast<uint32_t>(y) * 0xd8163841u);
+
+    // Murmur3 finalizer: every input bit affects every output bit
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Detects the widest instruction set supported by both the CPU and this build
+ *
+ * @returns the widest supported SIMD level
+ */
+SimdLevel detectSimdLevel() {
+    bool sse2 = false, avx2 = false, avx512 = false;
+#if PERLIN_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    sse2 = info[3] & (1 << 26);
+    bool fma = info[2] & (1 << 12);
+    bool osxsave = info[2] & (1 << 27);
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0; // Registers the OS saves on context switches
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = fma && (info[1] & (1 << 5)) && (xcr0 & 0x06) == 0x06;
+        avx512 = (info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6;
+    }
+#elif PERLIN_X86
+    __builtin_cpu_init();
+    sse2 = __builtin_cpu_supports("sse2");
+    avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    avx512 = __builtin_cpu_supports("avx512f");
+#endif
+#if PERLIN_X86
+    if (avx512 && hasAVX512Kernel())
+        return SimdLevel::AVX512;
+    if (avx2 && hasAVX2Kernel())
+        return SimdLevel::AVX2;
+    if (sse2)
+        return SimdLevel::SSE2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Gets a printable name for a SIMD level
+ *
+ * @param level the SIMD level
+ *
+ * @returns the name of the level
+ */
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE2:
+            return "SSE2";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+    }
+}
+
 /** 
  * @author Matt Luyten
  * @brief GradientNoise default constructor. Initializes random gradient generator with "random" seed based
  * on system time
  */
-GradientNoise::GradientNoise() : _gradient1(std::time(NULL)), _gradient2(std::time(NULL)) {}
+GradientNoise::GradientNoise() : _gradient1(std::time(NULL)), _gradient2(std::time(NULL)), _simdLevel(detectSimdLevel()) {}
 
 /**
  * @author Matt Luyten
@@ -45,7 +134,7 @@ GradientNoise::GradientNoise() : _gradient1(std::time(NULL)), _gradient2(std::ti
  * 
  * @param seed a 64-bit random seed for noise generator
  */
-GradientNoise::GradientNoise(uint32_t seed) : _gradient1(seed), _gradient2(seed) {}
+GradientNoise::GradientNoise(uint32_t seed) : _gradient1(seed), _gradient2(seed), _simdLevel(detectSimdLevel()) {}
 
 /**
  * @author Matt Luyten
@@ -53,6 +142,16 @@ GradientNoise::GradientNoise(uint32_t seed) : _gradient1(seed), _gradient2(seed)
  */
 GradientNoise::~GradientNoise() {}
 
+/**
+ * @author Matt Luyten
+ * @brief Sets the SIMD level used by fractalPerlin2DRow. Levels wider than detectSimdLevel() are clamped to it.
+ *
+ * @param level the requested SIMD level
+ */
+void GradientNoise::setSimdLevel(SimdLevel level) {
+    _simdLevel = std::min(level, detectSimdLevel());
+}
+
 /**
  * @author Matt Luyten
  * @brief Gradient2 constructor with specified seed
@@ -72,12 +171,7 @@ GradientNoise::Gradient2::Gradient2(uint32_t seed) {
  * @return a random gradient
  */
 glm::vec2 GradientNoise::Gradient2::at(glm::vec2 position) {
-    std::pair<int, int> pos = std::pair<int, int>(position.x, position.y);
-    std::unique_lock<std::mutex> lock(_m); // Protect _gradients when emplacing/reading
-    if (_gradients.count(pos) == 0) { // Check if gradient at this position
-        _gradients.emplace(pos, generate(position.x, position.y)); // If no gradient, generate one
-    }
-    return _gradients[pos];
+    return generate(position.x, position.y); // Gradients are stateless, no cache or lock needed
 }
 
 /**
@@ -90,12 +184,7 @@ glm::vec2 GradientNoise::Gradient2::at(glm::vec2 position) {
  * @return the gradient at (x, y)
  */
 glm::vec2 GradientNoise::Gradient2::at(int x, int y) {
-    std::pair<int, int> pos = std::pair<int, int>(x, y);
-    std::unique_lock<std::mutex> lock(_m); // Protect _gradients when emplacing/reading
-    if (_gradients.count(pos) == 0) { // Check if gradient at this position
-        _gradients.emplace(pos, generate(x, y)); // If no gradient, generate one
-    }
-    return _gradients[pos];
+    return generate(x, y); // Gradients are stateless, no cache or lock needed
 }
 
 /**
@@ -109,8 +198,7 @@ glm::vec2 GradientNoise::Gradient2::at(int x, int y) {
  */
 glm::vec2 GradientNoise::Gradient2::generate(int x, int y) {
     int N = 8; // Number of gradients available
-    uint32_t perm = lfsr(_seed + x, abs(x)); // Get a random seed based on x
-    perm = lfsr(perm + y, abs(y)); // Get a random number using previous seed and y
+    uint32_t perm = latticeHash(_seed, x, y); // Get a random number based on x and y
     perm = perm % N; // Coerce random number to [0,7]
 
     // Return corresponding gradient
@@ -166,7 +254,7 @@ double GradientNoise::Gradient1::at(int x) {
  */
 double GradientNoise::Gradient1::generate(int x) {
     int N = 5;
-    uint32_t perm = lfsr(_seed + x, abs(x)); // Get random number based on value of x
+    uint32_t perm = latticeHash(_seed, x, 0); // Get random number based on value of x
     perm = perm % N; // Coerce random number to [0, 5]
 
     // Return corresponding gradient
@@ -182,6 +270,81 @@ double GradientNoise::Gradient1::generate(int x) {
         return -1;
 }
 
+/**
+ * @author Matt Luyten
+ * @brief Empty tile constructor
+ */
+GradientNoise::GradientTile::GradientTile() : _x0(0), _y0(0), _width(0), _height(0) {}
+
+/**
+ * @author Matt Luyten
+ * @brief Allocates a tile covering the given lattice rectangle. Gradients are left uninitialized.
+ *
+ * @param x0 the smallest lattice x position in the tile
+ * @param y0 the smallest lattice y position in the tile
+ * @param width number of lattice positions along x
+ * @param height number of lattice positions along y
+ */
+GradientNoise::GradientTile::GradientTile(int x0, int y0, int width, int height)
+    : _x0(x0), _y0(y0), _width(width), _height(height), _gradients(static_cast<size_t>(width) * height) {}
+
+/**
+ * @author Matt Luyten
+ * @brief Builds the gradient tile needed to sample perlin2D over the rectangle [xMin, xMax] x [yMin, yMax].
+ * The tile has a margin of one lattice cell on each side so that the float kernels, which may round a sample
+ * onto the neighbouring cell, stay inside it.
+ *
+ * @param xMin smallest x sample position (already scaled by frequency)
+ * @param yMin smallest y sample position (already scaled by frequency)
+ * @param xMax largest x sample position (already scaled by frequency)
+ * @param yMax largest y sample position (already scaled by frequency)
+ *
+ * @return the gradient tile
+ */
+GradientNoise::GradientTile GradientNoise::buildTile(double xMin, double yMin, double xMax, double yMax) {
+    // perlin2D reads the lattice corners floor(x) and floor(x)+1 of every sample, plus one cell of margin per side
+    int x0 = static_cast<int>(floor(xMin)) - 1;
+    int y0 = static_cast<int>(floor(yMin)) - 1;
+    GradientTile tile(x0, y0, static_cast<int>(floor(xMax)) + 3 - x0, static_cast<int>(floor(yMax)) + 3 - y0);
+
+    for (int j = 0; j < tile._height; j++) { // Fill the tile row by row
+        for (int i = 0; i < tile._width; i++) {
+            tile._gradients[j * tile._width + i] = _gradient2.at(x0 + i, y0 + j);
+        }
+    }
+    return tile;
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Builds one gradient tile per octave for fractalPerlin2D over the rectangle [xMin, xMax] x [yMin, yMax].
+ * The frequencies follow the same schedule as fractalPerlin2D.
+ *
+ * @param tiles output vector, resized to the number of octaves
+ * @param xMin smallest x sample position
+ * @param yMin smallest y sample position
+ * @param xMax largest x sample position
+ * @param yMax largest y sample position
+ * @param mode noise mode
+ * @param octaves number of octaves of noise to layer
+ * @param freqStart noise frequency starting value
+ * @param freqRate rate of frequency change between octaves
+ */
+void GradientNoise::buildOctaveTiles(std::vector<GradientTile>& tiles, double xMin, double yMin, double xMax, double yMax,
+        int mode, int octaves, double freqStart, double freqRate) {
+    double freq = freqStart; // Set starting frequency
+
+    // Same frequency adjustment as fractalPerlin2D
+    if (mode == 1 || mode == 2)
+        freq = freq / 2;
+
+    tiles.resize(octaves);
+    for (int k = 0; k < octaves; k++) { // One tile per octave
+        tiles[k] = buildTile(xMin * freq, yMin * freq, xMax * freq, yMax * freq);
+        freq *= freqRate; // Increase frequency
+    }
+}
+
 /**
  * @author Matt Luyten
  * @brief Generates noise (z) for an input (x, y) + the gradient vector
@@ -223,6 +386,32 @@ glm::vec3 GradientNoise::perlin2D(double x, double y) {
             nx0 * (1 - easeCurve<double>(v)) + nx1 * easeCurve<double>(v)); // Interpolate y component between 
 }
 
+/**
+ * @author Matt Luyten
+ * @brief Same as perlin2D, but reads the gradients from a prebuilt tile instead of the gradient manager
+ *
+ * @param x the input x position for noise value z
+ * @param y the input y position for noise value z
+ * @param tile gradient tile covering the lattice cell of (x, y)
+ *
+ * @return the noise value
+ */
+glm::vec3 GradientNoise::perlin2D(double x, double y, const GradientTile& tile) {
+    int x0 = floor(x); // Lattice cell of the sample
+    int y0 = floor(y);
+    double u = x - x0; // Get fractional component of x
+    double v = y - y0; // Get fractional component of y
+    double n00 = glm::dot(tile.at(x0, y0), glm::vec2(u, v)); // Get vector from gradient00 to pos
+    double n10 = glm::dot(tile.at(x0+1, y0), glm::vec2(u-1, v)); // Get vector from gradient10 to pos
+    double n01 = glm::dot(tile.at(x0, y0+1), glm::vec2(u, v-1)); // Get vector from gradient01 to pos
+    double n11 = glm::dot(tile.at(x0+1, y0+1), glm::vec2(u-1, v-1)); // Get vector from gradient11 to pos
+    double nx0 = n00 * (1 - easeCurve<double>(u)) + n10 * easeCurve<double>(u); // Interpolate between gradient00 and gradient10
+    double nx1 = n01 * (1 - easeCurve<double>(u)) + n11 * easeCurve<double>(u); // Interpolate between gradient 01 and gradient 11
+    return glm::vec3(easeCurveGradient<double>(u) * (n10 - n00 + (n00 - n10 - n01 + n11) * easeCurve<double>(v)), // Get derivative in X direction
+            easeCurveGradient<double>(v) * (n00 - n01 + (n00 - n10 - n01 + n11) * easeCurve<double>(u)), // Get derivative in Y direction
+            nx0 * (1 - easeCurve<double>(v)) + nx1 * easeCurve<double>(v)); // Interpolate y component between
+}
+
 /**
  * @author Matt Luyten
  * @brief Implements fractal perlin noise in 3 modes (regular, turbulent, and opalescent) for 1D perlin noise
@@ -339,4 +528,145 @@ void GradientNoise::fractalPerlin2D(glm::vec3& pos, double max, int mode, int oc
     else
         pos.y *= max;
     return;
-}
\ No newline at end of file
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Same as the vec3 fractalPerlin2D, but reads gradients from per-octave tiles built by buildOctaveTiles.
+ * The number of octaves is the number of tiles.
+ *
+ * @param pos position of the sample, pos.y receives the noise value
+ * @param tiles one gradient tile per octave
+ * @param max maximum value (+/-) of the noise
+ * @param mode noise mode
+ * @param freqStart noise frequency starting value
+ * @param freqRate rate of frequency change between octaves
+ * @param ampRate rate of amplitude change between octaves
+ */
+void GradientNoise::fractalPerlin2D(glm::vec3& pos, const std::vector<GradientTile>& tiles, double max, int mode,
+        double freqStart, double freqRate, double ampRate) {
+    double freq = freqStart; // Set starting frequency
+    double amplitude = 1; // Set starting amplitude
+
+    // These make all modes make similarly bumpy noise at the same starting frequency
+    if (mode == 1 || mode == 2)
+        freq = freq / 2;
+
+    for (size_t k = 0; k < tiles.size(); k++) { // Iterate over the octave tiles
+        glm::vec3 noise = perlin2D(pos.x*freq, pos.z*freq, tiles[k]); // Get perlin noise at this octave
+        // Mode 3 adds octaves like mode 0: its slope weighting in the overloads above leaves amplitude unchanged
+
+        if (mode == 1 || mode == 2)  // Use magnitude of noise for modes 1 and 2 (turbulent & opalescent)
+            pos.y += amplitude * abs(noise.z);
+        else // Standard fractal
+            pos.y += amplitude * noise.z;
+
+        amplitude *= ampRate; // Decrease amplitude
+        freq *= freqRate; // Increase frequency
+    }
+
+    // Scale noise value so that it does not exceed max
+    if (mode == 1)
+        pos.y = pos.y * 2 * max - max;
+    else if (mode == 2)
+        pos.y = max / 5 * cos(2 * M_PI * pos.y);
+    else
+        pos.y *= max;
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the batched kernel for a noise mode and a number of octaves, using the SIMD level of this
+ * generator. The kernel is specialized at compile time so that it has no mode branches and, for 4, 6, 8 and 12
+ * octaves, a fully unrolled octave loop. Select it once and reuse it for every row.
+ * The float kernels process twice as many samples per instruction as the double ones. Their error grows with the
+ * lattice coordinates (see test/precision-test.cpp).
+ *
+ * @tparam T scalar type of the computations (float or double)
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel GradientNoise::rowKernel(int mode, int octaves) const {
+    switch (_simdLevel) {
+#if PERLIN_X86
+        case SimdLevel::AVX512:
+            return rowKernelAVX512<T>(mode, octaves);
+        case SimdLevel::AVX2:
+            return rowKernelAVX2<T>(mode, octaves);
+        case SimdLevel::SSE2:
+            return rowKernelSSE2<T>(mode, octaves);
+#endif
+        default:
+            return selectRowKernel<ScalarLanes<T>>(mode, octaves);
+    }
+}
+
+template NoiseRowKernel GradientNoise::rowKernel<float>(int mode, int octaves) const;
+template NoiseRowKernel GradientNoise::rowKernel<double>(int mode, int octaves) const;
+
+/**
+ * @author Matt Luyten
+ * @brief Batched version of the tiled fractalPerlin2D. Evaluates a row of samples given in SoA form with the widest
+ * SIMD instruction set selected for this generator. Mode 3 gives the same result as mode 0, as in the per-point version.
+ *
+ * @param xs x positions of the samples
+ * @param zs z positions of the samples
+ * @param heights output noise values, one per sample
+ * @param count number of samples
+ * @param tiles one gradient tile per octave, covering every sample
+ * @param max maximum value (+/-) of the noise
+ * @param mode noise mode
+ * @param freqStart noise frequency starting value
+ * @param freqRate rate of frequency change between octaves
+ * @param ampRate rate of amplitude change between octaves
+ */
+void GradientNoise::fractalPerlin2DRow(const float* xs, const float* zs, float* heights, size_t count,
+        const std::vector<GradientTile>& tiles, double max, int mode, double freqStart, double freqRate, double ampRate) {
+    fractalPerlin2DRow(rowKernel(mode, static_cast<int>(tiles.size())), xs, zs, heights, count, tiles, max,
+            freqStart, freqRate, ampRate);
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Same as above, but runs a kernel selected beforehand with rowKernel. The tiles must have been built
+ * with the same mode and number of octaves as the kernel.
+ *
+ * @param kernel kernel returned by rowKernel
+ * @param xs x positions of the samples
+ * @param zs z positions of the samples
+ * @param heights output noise values, one per sample
+ * @param count number of samples
+ * @param tiles one gradient tile per octave, covering every sample
+ * @param max maximum value (+/-) of the noise
+ * @param freqStart noise frequency starting value
+ * @param freqRate rate of frequency change between octaves
+ * @param ampRate rate of amplitude change between octaves
+ */
+void GradientNoise::fractalPerlin2DRow(NoiseRowKernel kernel, const float* xs, const float* zs, float* heights, size_t count,
+        const std::vector<GradientTile>& tiles, double max, double freqStart, double freqRate, double ampRate) {
+    // Plain view of the tiles for the kernel
+    std::vector<OctaveTile> octaveTiles(tiles.size());
+    for (size_t k = 0; k < tiles.size(); k++) {
+        octaveTiles[k].gradients = tiles[k].data();
+        octaveTiles[k].x0 = tiles[k].x0();
+        octaveTiles[k].y0 = tiles[k].y0();
+        octaveTiles[k].width = tiles[k].width();
+    }
+
+    NoiseRowArgs args;
+    args.xs = xs;
+    args.zs = zs;
+    args.heights = heights;
+    args.count = count;
+    args.tiles = octaveTiles.data();
+    args.octaves = static_cast<int>(tiles.size());
+    args.max = max;
+    args.freqStart = freqStart;
+    args.freqRate = freqRate;
+    args.ampRate = ampRate;
+    kernel(args);
+}
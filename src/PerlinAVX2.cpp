@@ -0,0 +1,125 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+AVX2 instantiation of the batched fractal perlin kernel (4 double or 8 float lanes). This file is compiled with AVX2
+and FMA enabled.
+*/
+
+#include "PerlinKernel.hpp"
+
+#if PERLIN_X86 && defined(__AVX2__)
+#include <immintrin.h>
+
+// Internal linkage: the kernels instantiated with these policies must not be merged with other translation units
+namespace {
+
+/**
+ * @author Matt Luyten
+ * @brief AVX2 lanes policies. Gradients are fetched with hardware gathers.
+ */
+template <typename T>
+struct AVX2Lanes;
+
+template <>
+struct AVX2Lanes<double> {
+    typedef __m256d V;
+    typedef __m128i I;
+    static const size_t width = 4;
+
+    static V loadf(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    static void storef(float* p, V v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+    static V set1(double d) { return _mm256_set1_pd(d); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+    static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static V floor(V a) { return _mm256_floor_pd(a); }
+    static I index(V row, V col, int width) {
+        return _mm_add_epi32(_mm_mullo_epi32(_mm256_cvttpd_epi32(row), _mm_set1_epi32(width)), _mm256_cvttpd_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        const float* base = reinterpret_cast<const float*>(g);
+        gx = _mm256_cvtps_pd(_mm_i32gather_ps(base, idx, sizeof(glm::vec2)));
+        gy = _mm256_cvtps_pd(_mm_i32gather_ps(base + 1, idx, sizeof(glm::vec2)));
+    }
+};
+
+template <>
+struct AVX2Lanes<float> {
+    typedef __m256 V;
+    typedef __m256i I;
+    static const size_t width = 8;
+
+    static V loadf(const float* p) { return _mm256_loadu_ps(p); }
+    static void storef(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(double d) { return _mm256_set1_ps(static_cast<float>(d)); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+    static V floor(V a) { return _mm256_floor_ps(a); }
+    static I index(V row, V col, int width) {
+        return _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(row), _mm256_set1_epi32(width)), _mm256_cvttps_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        const float* base = reinterpret_cast<const float*>(g);
+        gx = _mm256_i32gather_ps(base, idx, sizeof(glm::vec2));
+        gy = _mm256_i32gather_ps(base + 1, idx, sizeof(glm::vec2));
+    }
+};
+
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the AVX2 kernel specialized on the noise mode and the number of octaves
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel rowKernelAVX2(int mode, int octaves) {
+    return selectRowKernel<AVX2Lanes<T>>(mode, octaves);
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Tells whether this file was compiled with AVX2 enabled
+ */
+bool hasAVX2Kernel() { return true; }
+#elif PERLIN_X86
+/**
+ * @author Matt Luyten
+ * @brief This build has no AVX2 support and detectSimdLevel() never selects these kernels. Defined with the scalar
+ * policy so that the symbol exists.
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel rowKernelAVX2(int mode, int octaves) {
+    return selectRowKernel<ScalarLanes<T>>(mode, octaves);
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Tells whether this file was compiled with AVX2 enabled
+ */
+bool hasAVX2Kernel() { return false; }
+#endif
+
+#if PERLIN_X86
+template NoiseRowKernel rowKernelAVX2<float>(int mode, int octaves);
+template NoiseRowKernel rowKernelAVX2<double>(int mode, int octaves);
+#endif
@@ -0,0 +1,125 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+AVX-512 instantiation of the batched fractal perlin kernel (8 double or 16 float lanes). This file is compiled with
+AVX-512F enabled.
+*/
+
+#include "PerlinKernel.hpp"
+
+#if PERLIN_X86 && defined(__AVX512F__)
+#include <immintrin.h>
+
+// Internal linkage: the kernels instantiated with these policies must not be merged with other translation units
+namespace {
+
+/**
+ * @author Matt Luyten
+ * @brief AVX-512 lanes policies. Gradients are fetched with hardware gathers.
+ */
+template <typename T>
+struct AVX512Lanes;
+
+template <>
+struct AVX512Lanes<double> {
+    typedef __m512d V;
+    typedef __m256i I;
+    static const size_t width = 8;
+
+    static V loadf(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+    static void storef(float* p, V v) { _mm256_storeu_ps(p, _mm512_cvtpd_ps(v)); }
+    static V set1(double d) { return _mm512_set1_pd(d); }
+    static V add(V a, V b) { return _mm512_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+    static V abs(V a) { return _mm512_abs_pd(a); }
+    static V floor(V a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+    static I index(V row, V col, int width) {
+        return _mm256_add_epi32(_mm256_mullo_epi32(_mm512_cvttpd_epi32(row), _mm256_set1_epi32(width)), _mm512_cvttpd_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        const float* base = reinterpret_cast<const float*>(g);
+        gx = _mm512_cvtps_pd(_mm256_i32gather_ps(base, idx, sizeof(glm::vec2)));
+        gy = _mm512_cvtps_pd(_mm256_i32gather_ps(base + 1, idx, sizeof(glm::vec2)));
+    }
+};
+
+template <>
+struct AVX512Lanes<float> {
+    typedef __m512 V;
+    typedef __m512i I;
+    static const size_t width = 16;
+
+    static V loadf(const float* p) { return _mm512_loadu_ps(p); }
+    static void storef(float* p, V v) { _mm512_storeu_ps(p, v); }
+    static V set1(double d) { return _mm512_set1_ps(static_cast<float>(d)); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+    static V abs(V a) { return _mm512_abs_ps(a); }
+    static V floor(V a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+    static I index(V row, V col, int width) {
+        return _mm512_add_epi32(_mm512_mullo_epi32(_mm512_cvttps_epi32(row), _mm512_set1_epi32(width)), _mm512_cvttps_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm512_add_epi32(a, _mm512_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        const float* base = reinterpret_cast<const float*>(g);
+        gx = _mm512_i32gather_ps(idx, base, sizeof(glm::vec2));
+        gy = _mm512_i32gather_ps(idx, base + 1, sizeof(glm::vec2));
+    }
+};
+
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the AVX-512 kernel specialized on the noise mode and the number of octaves
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel rowKernelAVX512(int mode, int octaves) {
+    return selectRowKernel<AVX512Lanes<T>>(mode, octaves);
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Tells whether this file was compiled with AVX-512 enabled
+ */
+bool hasAVX512Kernel() { return true; }
+#elif PERLIN_X86
+/**
+ * @author Matt Luyten
+ * @brief This build has no AVX-512 support and detectSimdLevel() never selects these kernels. Defined with the scalar
+ * policy so that the symbol exists.
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel rowKernelAVX512(int mode, int octaves) {
+    return selectRowKernel<ScalarLanes<T>>(mode, octaves);
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Tells whether this file was compiled with AVX-512 enabled
+ */
+bool hasAVX512Kernel() { return false; }
+#endif
+
+#if PERLIN_X86
+template NoiseRowKernel rowKernelAVX512<float>(int mode, int octaves);
+template NoiseRowKernel rowKernelAVX512<double>(int mode, int octaves);
+#endif
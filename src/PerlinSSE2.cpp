@@ -0,0 +1,118 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+SSE2 instantiation of the batched fractal perlin kernel (2 double or 4 float lanes). This file is compiled with SSE2 enabled.
+*/
+
+#include "PerlinKernel.hpp"
+
+#if PERLIN_X86
+#include <emmintrin.h>
+
+// Internal linkage: the kernels instantiated with these policies must not be merged with other translation units
+namespace {
+
+/**
+ * @author Matt Luyten
+ * @brief Multiplies 32-bit integers lane by lane. SSE2 has no _mm_mullo_epi32, emulate it with two 64-bit products.
+ *
+ * @param a first factors
+ * @param b second factors
+ *
+ * @return the low 32 bits of the products
+ */
+inline __m128i mullo(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b); // Lanes 0 and 2
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4)); // Lanes 1 and 3
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/**
+ * @author Matt Luyten
+ * @brief SSE2 lanes policies. SSE2 has no floor or gather instructions, both are emulated.
+ */
+template <typename T>
+struct SSE2Lanes;
+
+template <>
+struct SSE2Lanes<double> {
+    typedef __m128d V;
+    typedef __m128i I;  // Indices in the 2 low lanes
+    static const size_t width = 2;
+
+    static V loadf(const float* p) { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))); }
+    static void storef(float* p, V v) { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(_mm_cvtpd_ps(v))); }
+    static V set1(double d) { return _mm_set1_pd(d); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static V abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static V floor(V a) {
+        V t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(a)); // Truncate toward zero
+        return _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, a), _mm_set1_pd(1))); // Step down for negative non-integers
+    }
+    static I index(V row, V col, int width) {
+        return _mm_add_epi32(mullo(_mm_cvttpd_epi32(row), _mm_set1_epi32(width)), _mm_cvttpd_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        int i[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(i), idx);
+        gx = _mm_set_pd(g[i[1]].x, g[i[0]].x);
+        gy = _mm_set_pd(g[i[1]].y, g[i[0]].y);
+    }
+};
+
+template <>
+struct SSE2Lanes<float> {
+    typedef __m128 V;
+    typedef __m128i I;
+    static const size_t width = 4;
+
+    static V loadf(const float* p) { return _mm_loadu_ps(p); }
+    static void storef(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(double d) { return _mm_set1_ps(static_cast<float>(d)); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V fmadd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static V floor(V a) {
+        V t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); // Truncate toward zero
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1))); // Step down for negative non-integers
+    }
+    static I index(V row, V col, int width) {
+        return _mm_add_epi32(mullo(_mm_cvttps_epi32(row), _mm_set1_epi32(width)), _mm_cvttps_epi32(col));
+    }
+    static I addi(I a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+    static void gather(const glm::vec2* g, I idx, V& gx, V& gy) {
+        int i[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(i), idx);
+        gx = _mm_set_ps(g[i[3]].x, g[i[2]].x, g[i[1]].x, g[i[0]].x);
+        gy = _mm_set_ps(g[i[3]].y, g[i[2]].y, g[i[1]].y, g[i[0]].y);
+    }
+};
+
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Selects the SSE2 kernel specialized on the noise mode and the number of octaves
+ *
+ * @param mode noise mode
+ * @param octaves number of octaves
+ *
+ * @return the kernel
+ */
+template <typename T>
+NoiseRowKernel rowKernelSSE2(int mode, int octaves) {
+    return selectRowKernel<SSE2Lanes<T>>(mode, octaves);
+}
+
+template NoiseRowKernel rowKernelSSE2<float>(int mode, int octaves);
+template NoiseRowKernel rowKernelSSE2<double>(int mode, int octaves);
+#endif
@@ -0,0 +1,82 @@
+/*
+Author: Matthew Luyten
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Validation and hashing of the terrain generation parameters.
+*/
+
+#include "TerrainParams.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @author Matt Luyten
+ * @brief Mixes the bytes of a value into a FNV-1a hash
+ *
+ * @param hash current hash value
+ * @param value value to mix in
+ *
+ * @return the new hash value
+ */
+template <typename T>
+static uint64_t fnv1a(uint64_t hash, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull; // FNV prime
+    }
+    return hash;
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Checks that the parameters describe a terrain that can be generated
+ *
+ * @throws std::invalid_argument naming the first invalid parameter
+ */
+void TerrainParams::validate() const {
+    if (size < 2)
+        throw std::invalid_argument("--size must be at least 2");
+    if (!(resolution > 0))
+        throw std::invalid_argument("--resolution must be positive");
+    if (octaves < 1 || octaves > 32)
+        throw std::invalid_argument("--octaves must be between 1 and 32");
+    if (!(freqStart > 0) || !(freqRate > 0))
+        throw std::invalid_argument("--freq-start and --freq-rate must be positive");
+    if (!(ampRate > 0))
+        throw std::invalid_argument("--amp-rate must be positive");
+    if (mode < 0 || mode > 3)
+        throw std::invalid_argument("--mode must be 0, 1, 2 or 3");
+    if (!(max > 0))
+        throw std::invalid_argument("--max must be positive");
+    if (precision != 32 && precision != 64)
+        throw std::invalid_argument("--precision must be 32 or 64, got " + std::to_string(precision));
+}
+
+/**
+ * @author Matt Luyten
+ * @brief Hashes the parameters that change the generated heights (everything but the visibility). Two parameter
+ * sets with the same hash generate the same chunks, so the hash can be used in cache keys.
+ *
+ * @return 64 bit FNV-1a hash of the parameters
+ */
+uint64_t TerrainParams::hash() const {
+    uint64_t h = 14695981039346656037ull; // FNV offset basis
+
+    // Hash field by field so that struct padding does not leak into the hash
+    h = fnv1a(h, static_cast<uint64_t>(size));
+    h = fnv1a(h, resolution);
+    h = fnv1a(h, octaves);
+    h = fnv1a(h, seed);
+    h = fnv1a(h, freqStart);
+    h = fnv1a(h, freqRate);
+    h = fnv1a(h, ampRate);
+    h = fnv1a(h, mode);
+    h = fnv1a(h, max);
+    h = fnv1a(h, precision);
+    return h;
+}
@@ -0,0 +1,189 @@
+/*
+Author: Lydia Jameson
+Class: ECE6122
+Last Date Modified: 10/17/2026
+
+Description:
+Thread Pool class implementation file. A fixed number of worker threads, sized to the hardware, run the chunk generation
+jobs. Each worker owns a job queue and steals from the other queues when its own is empty. Every job has a priority
+(lower runs first), so that the chunks nearest to the camera are generated first.
+*/
+
+// Standard libraries
+#include <algorithm>
+
+// Header file
+#include "ThreadPool.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Constructor. Starts the worker threads.
+ * @param threads : number of worker threads, 0 uses one per hardware thread but the render thread
+ */
+ThreadPool::ThreadPool(unsigned int threads) : m_sequence(0), m_queued(0), m_pending(0), m_stolen(0), m_stop(false) {
+
+	// Size the pool to the hardware, keeping a core for the render thread
+	if (threads == 0) {
+		unsigned int hardware = std::thread::hardware_concurrency();
+		threads = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	// Create the queues before any worker can steal from them
+	for (unsigned int i = 0; i < threads; i++) {
+		m_queues.emplace_back(new WorkerQueue());
+	}
+	for (unsigned int i = 0; i < threads; i++) {
+		m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Queue a job. Jobs are spread over the worker queues in turn. The priority function is only called from
+ * submit() and reprioritize(), so it may read state owned by the calling thread.
+ * @param task : work to run
+ * @param priority : priority of the job, lower runs first
+ */
+void ThreadPool::submit(Task task, Priority priority) {
+
+	// Build the job
+	Job job;
+	job.cachedPriority = priority();
+	job.task = std::move(task);
+	job.priority = std::move(priority);
+	job.sequence = m_sequence++;
+
+	// Count the job before it can be taken (under the sleep mutex so that no wake-up is lost)
+	std::unique_lock<std::mutex> lck(m_sleepMut);
+	m_pending++;
+	m_queued++;
+	lck.unlock();
+
+	// Push it to the next queue and wake up a worker
+	WorkerQueue& queue = *m_queues[job.sequence % m_queues.size()];
+	std::unique_lock<std::mutex> queueLck(queue.mut);
+	queue.jobs.push_back(std::move(job));
+	queueLck.unlock();
+	m_wake.notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Evaluate the priority of every queued job again, for instance when the camera has moved
+ */
+void ThreadPool::reprioritize() {
+	for (auto& queue : m_queues) {
+		std::unique_lock<std::mutex> lck(queue->mut);
+		for (auto& job : queue->jobs) {
+			job.cachedPriority = job.priority();
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Wait until every queued job is done
+ */
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lck(m_sleepMut);
+	m_idle.wait(lck, [this] { return m_pending.load() == 0; });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Take the job with the lowest priority from a queue. The queues hold at most a few rings of chunks, so a
+ * linear search is cheaper than keeping them sorted while the priorities change.
+ * @param queue : queue to take the job from
+ * @param job : receives the job
+ * @return true if a job was taken, false if the queue is empty
+ */
+bool ThreadPool::takeBest(WorkerQueue& queue, Job& job) {
+	std::unique_lock<std::mutex> lck(queue.mut);
+	if (queue.jobs.empty()) {
+		return false;
+	}
+
+	// Find the job with the lowest priority, the oldest one first on ties
+	auto best = std::min_element(queue.jobs.begin(), queue.jobs.end(), [](const Job& a, const Job& b) {
+		return a.cachedPriority < b.cachedPriority || (a.cachedPriority == b.cachedPriority && a.sequence < b.sequence);
+	});
+
+	// Move it out and fill the hole with the last job
+	job = std::move(*best);
+	if (best != queue.jobs.end() - 1) {
+		*best = std::move(queue.jobs.back());
+	}
+	queue.jobs.pop_back();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Main loop of a worker thread: run the best job of its own queue, or steal one from the other queues,
+ * or sleep until a job is queued
+ * @param index : index of the worker and of its queue
+ */
+void ThreadPool::workerLoop(size_t index) {
+	while (true) {
+
+		// Look in the worker's own queue first, then steal from the others
+		Job job;
+		bool found = takeBest(*m_queues[index], job);
+		for (size_t i = 1; !found && i < m_queues.size(); i++) {
+			found = takeBest(*m_queues[(index + i) % m_queues.size()], job);
+			if (found) {
+				m_stolen++;
+			}
+		}
+
+		if (found) {
+			m_queued--;
+			job.task();
+
+			// Wake up wait() callers when the last job is done
+			std::unique_lock<std::mutex> lck(m_sleepMut);
+			if (--m_pending == 0) {
+				m_idle.notify_all();
+			}
+			continue;
+		}
+
+		// Nothing to do: sleep until a job is queued or the pool is destroyed
+		std::unique_lock<std::mutex> lck(m_sleepMut);
+		m_wake.wait(lck, [this] { return m_stop || m_queued.load() > 0; });
+		if (m_stop) {
+			return;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Destructor : drops the queued jobs, waits for the running ones and joins the workers
+ */
+ThreadPool::~ThreadPool() {
+
+	// Drop the jobs that have not started
+	for (auto& queue : m_queues) {
+		std::unique_lock<std::mutex> lck(queue->mut);
+		m_queued -= queue->jobs.size();
+		m_pending -= queue->jobs.size();
+		queue->jobs.clear();
+	}
+
+	// Stop the workers
+	std::unique_lock<std::mutex> lck(m_sleepMut);
+	m_stop = true;
+	lck.unlock();
+	m_wake.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
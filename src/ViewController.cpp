@@ -12,6 +12,9 @@ by the user inputs, managing the projection and view matrices.
 #include "ViewController.hpp"
 #include <iostream>
 
+// Length of the position history used to estimate the velocity [s]
+static const float VELOCITY_WINDOW = 0.25f;
+
 ///////////////////////////////////////////////////////////////////////////////
 /**
  * @author Thomas Etheve
@@ -51,6 +54,7 @@ ViewController::ViewController(const sf::Vector2u& windowSize,
 	// Set up the movement parameters
 	this->speed = speed;			 // Change of position (by the keyboard)
 	this->mouseSpeed = mouseSpeed;	 // Change of look angles (by the mouse)
+	this->elapsedTime = 0.f;		 // No time elapsed yet
 
     // Define the projection parameters
 	this->orthographicProjection = false;	// Orthographic projection mode
@@ -101,6 +105,14 @@ void ViewController::computeMatricesFromInputs(sf::RenderWindow& window)
 		// Actualize the triangle rendering mode
 		this->updateTriangleRendering();
 	}
+
+	// Record the new position and forget the samples older than the velocity window
+	this->elapsedTime += dt;
+	this->positionHistory.emplace_back(this->elapsedTime, this->position);
+	while(this->positionHistory.size() > 2 && this->positionHistory.front().first < this->elapsedTime - VELOCITY_WINDOW)
+	{
+		this->positionHistory.pop_front();
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -197,6 +209,9 @@ void ViewController::updateLook(sf::RenderWindow& window)
 		this->verticalAngle = 0.f;
 		this->speed = 5.f;
 		this->fov_deg = 45;
+
+		// The jump is not a movement, do not extrapolate it
+		this->positionHistory.clear();
 	}
 
 	// Compute the projection matrix according to the projection mode
@@ -443,4 +458,24 @@ glm::mat4 ViewController::getViewMatrix()
 glm::vec3 ViewController::getPosition()
 {
 	return position;
-}
\ No newline at end of file
+}
+///////////////////////////////////////////////////////////////////////////////
+/**
+ * @author Lydia Jameson
+ * @brief Get the user's velocity, averaged over the last VELOCITY_WINDOW seconds of positions
+ * @return glm::vec3 [m/s, m/s, m/s]
+ */
+glm::vec3 ViewController::getVelocity()
+{
+	if(this->positionHistory.size() < 2)
+	{
+		return glm::vec3(0, 0, 0);
+	}
+
+	float dt = this->positionHistory.back().first - this->positionHistory.front().first;
+	if(dt <= 0.f)
+	{
+		return glm::vec3(0, 0, 0);
+	}
+	return (this->positionHistory.back().second - this->positionHistory.front().second) / dt;
+}
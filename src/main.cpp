@@ -22,6 +22,8 @@ shell scripts to run the program with the desired arguments.
 #include <map>
 #include <utility>
 #include <iostream>
+#include <stdexcept>
+#include <memory>
 #include <omp.h>
 
 // Include GLEW
@@ -43,9 +45,11 @@ using namespace glm;
 
 // Include project classes
 #include "ChunkManager.hpp"
+#include "TerrainParams.hpp"
 #include "ViewController.hpp"
 #include "ColorMap.hpp"
 #include "Chunk.hpp"
+#include "ClipmapRenderer.hpp"
 
 // Program option namespace
 namespace po = boost::program_options;
@@ -57,6 +61,11 @@ int main(int argc, char* argv[])
 	 ********************************************************************/
 	std::srand(time(NULL)); // Seed random number generator for 
 	po::variables_map arguments;  
+	TerrainParams params;		// Typed terrain parameters, read from the arguments
+	ChunkCacheOptions cacheOptions;	// Chunk cache and chunk store options, read from the arguments
+	StreamingOptions streamingOptions;	// Chunk streaming options, read from the arguments
+	RenderOptions renderOptions;	// Chunk rendering options, read from the arguments
+	ClipmapOptions clipmapOptions;	// Geometry clipmap options, read from the arguments
     try {
 		// Define all program options
         po::options_description desc("Allowed options");
@@ -75,6 +84,19 @@ int main(int argc, char* argv[])
             ("mode, m", po::value<int>()->default_value(0), "Noise mode (0 - fractal, 1 - turbulent, 2 - opalescent, 3 - gradient weighting)")
 			("max, m", po::value<double>()->default_value(5), "Noise max value")
 			("cmap, c", po::value<unsigned int>()->default_value(1), "Color map (0 - GRAY_SCALE, 1 - GIST_EARTH)")
+			("precision,p", po::value<unsigned int>()->default_value(64), "Noise evaluation precision in bits (32 or 64)")
+			("cache-dir", po::value<std::string>()->default_value("chunk_cache"), "Directory of the persistent chunk store (empty to disable)")
+			("cache-mb", po::value<double>()->default_value(64), "Memory budget of the recently dropped chunks in MB (0 to disable)")
+			("cache-gl", po::bool_switch()->default_value(false), "Keep the OpenGL buffers of the recently dropped chunks")
+			("prefetch-time", po::value<double>()->default_value(1.0), "Look-ahead time of the chunk prefetch in seconds (0 to disable)")
+			("unload-margin", po::value<int>()->default_value(1), "Chunks kept loaded beyond the view distance before they are unloaded")
+			("upload-ms", po::value<double>()->default_value(4.0), "Time per frame spent uploading new chunks or clipmap rows in milliseconds (0 for no limit)")
+			("multi-draw", po::bool_switch()->default_value(false), "Draw all the chunks with one glMultiDrawElementsBaseVertex call per frame")
+			("no-occlusion", po::bool_switch()->default_value(false), "Draw the chunks hidden behind nearer terrain")
+			("lod-pixels", po::value<double>()->default_value(2.0), "Largest screen-space height error of the chunks' level of detail in pixels (0 for full resolution)")
+			("clipmap", po::bool_switch()->default_value(false), "Draw the terrain with a geometry clipmap instead of the chunks")
+			("clipmap-levels", po::value<unsigned int>()->default_value(6), "Number of nested levels of the geometry clipmap")
+			("clipmap-size", po::value<unsigned int>()->default_value(129), "Points per side of a clipmap level (4k + 1)")
         ;
 
 		// Store program options
@@ -86,6 +108,63 @@ int main(int argc, char* argv[])
             std::cout << desc << "\n";
             return 0;
         }
+
+		// Read the terrain parameters once and validate them (throws std::invalid_argument)
+		params.size = arguments["size"].as<size_t>();
+		params.resolution = arguments["resolution"].as<double>();
+		params.visibility = arguments["visibility"].as<unsigned int>();
+		params.octaves = arguments["octaves"].as<int>();
+		params.seed = arguments["seed"].as<uint32_t>();
+		params.freqStart = arguments["freq-start"].as<double>();
+		params.freqRate = arguments["freq-rate"].as<double>();
+		params.ampRate = arguments["amp-rate"].as<double>();
+		params.mode = arguments["mode"].as<int>();
+		params.max = arguments["max"].as<double>();
+		params.precision = arguments["precision"].as<unsigned int>();
+		params.validate();
+
+		// Read the chunk cache options
+		if (arguments["cache-mb"].as<double>() < 0) {
+			throw std::invalid_argument("--cache-mb must not be negative");
+		}
+		cacheOptions.directory = arguments["cache-dir"].as<std::string>();
+		cacheOptions.memoryBytes = static_cast<size_t>(arguments["cache-mb"].as<double>() * (1 << 20));
+		cacheOptions.keepGLBuffers = arguments["cache-gl"].as<bool>();
+
+		// Read the chunk streaming options
+		if (arguments["prefetch-time"].as<double>() < 0) {
+			throw std::invalid_argument("--prefetch-time must not be negative");
+		}
+		if (arguments["unload-margin"].as<int>() < 0 || arguments["unload-margin"].as<int>() > 16) {
+			throw std::invalid_argument("--unload-margin must be between 0 and 16");
+		}
+		if (arguments["upload-ms"].as<double>() < 0) {
+			throw std::invalid_argument("--upload-ms must not be negative");
+		}
+		streamingOptions.prefetchTime = static_cast<float>(arguments["prefetch-time"].as<double>());
+		streamingOptions.uploadBudgetMs = static_cast<float>(arguments["upload-ms"].as<double>());
+		streamingOptions.unloadMargin = arguments["unload-margin"].as<int>();
+
+		// Read the chunk rendering options
+		renderOptions.multiDraw = arguments["multi-draw"].as<bool>();
+		renderOptions.occlusion = !arguments["no-occlusion"].as<bool>();
+		if (arguments["lod-pixels"].as<double>() < 0) {
+			throw std::invalid_argument("--lod-pixels must not be negative");
+		}
+		renderOptions.lodPixels = static_cast<float>(arguments["lod-pixels"].as<double>());
+
+		// Read the geometry clipmap options
+		clipmapOptions.enabled = arguments["clipmap"].as<bool>();
+		clipmapOptions.levels = arguments["clipmap-levels"].as<unsigned int>();
+		clipmapOptions.gridSize = arguments["clipmap-size"].as<unsigned int>();
+		clipmapOptions.updateBudgetMs = streamingOptions.uploadBudgetMs;
+		if (clipmapOptions.levels < 1 || clipmapOptions.levels > 16) {
+			throw std::invalid_argument("--clipmap-levels must be between 1 and 16");
+		}
+		if (clipmapOptions.gridSize < 9 || (clipmapOptions.gridSize - 1) % 4 != 0) {
+			throw std::invalid_argument("--clipmap-size must be 4k + 1, at least 9");
+		}
+		renderOptions.textureOnly = clipmapOptions.enabled;	// The chunks only feed the 2D map view under the clipmap
     }
 
 	// Check the command line arguments are valid
@@ -180,17 +259,24 @@ int main(int argc, char* argv[])
 
 	// Create the color map object
 	ColorMap colorMap(cmapType[arguments["cmap"].as<unsigned int>()], // ColorMap type
-						-1.f*arguments["max"].as<double>(), 		  // Minimum altitude: Centered on 0 - Max noise
-						arguments["max"].as<double>());			      // Maximum altitude: Centered on 0 + Max noise
+						-1.f*params.max, 							  // Minimum altitude: Centered on 0 - Max noise
+						params.max);								  // Maximum altitude: Centered on 0 + Max noise
+	colorMap.createTexture();										  // Lookup table of the fragment shader
 
 	/********************************************************************
 	 * Create hight map
 	 ********************************************************************/
 
-	// Create the chunk manager object (View distance = 3 chunks, color map pointer, using command line arguments)
-	ChunkManager manager(&colorMap, arguments);
+	// Create the chunk manager object (View distance = 3 chunks, color map pointer, using the terrain parameters)
+	ChunkManager manager(&colorMap, params, cacheOptions, streamingOptions, renderOptions);
 	std::cout << "manager created" << std::endl;
 
+	// Create the geometry clipmap renderer, the chunks then only feed the 2D map
+	std::unique_ptr<ClipmapRenderer> clipmap;
+	if (clipmapOptions.enabled) {
+		clipmap.reset(new ClipmapRenderer(params, &colorMap, clipmapOptions));
+	}
+
 	/********************************************************************
 	 * Main loop
 	 ********************************************************************/
@@ -202,7 +288,7 @@ int main(int argc, char* argv[])
     while (running)
     {
 		//create and destroy chunks as appropriate
-		manager.update(viewController.getPosition());
+		manager.update(viewController.getPosition(), viewController.getVelocity());
 
 		// Activate the shader program
 		glUseProgram(programID);
@@ -232,6 +318,11 @@ int main(int argc, char* argv[])
                 glViewport(0, 0, event.size.width, event.size.height);
 				viewController.setWindowSize(sf::Vector2u(event.size.width, event.size.height));
             }
+			// Switch the color map of the 3D view by pressing the key C (only its lookup table changes)
+			else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::C)
+			{
+				colorMap.setType(colorMap.getType() == ColorMapType::GIST_EARTH ? ColorMapType::GRAY_SCALE : ColorMapType::GIST_EARTH);
+			}
         }
 
 		/********************************************************************
@@ -276,9 +367,9 @@ int main(int argc, char* argv[])
 
 			// Set the position of the circle at the users position
 			glm::vec3 userPos = viewController.getPosition();						// Get the user position	
-			float chunkSize = static_cast<float>(arguments["size"].as<size_t>());	// Get the chunk size
-			circle.setPosition(origin.getPosition().x + userPos.x/static_cast<float>(arguments["resolution"].as<double>()), 	// Set position from the origin (x 3D = x window)
-							   origin.getPosition().y + userPos.z/static_cast<float>(arguments["resolution"].as<double>()));	// Set position from the origin (z 3D = y window)
+			float chunkSize = static_cast<float>(params.size);	// Get the chunk size
+			circle.setPosition(origin.getPosition().x + userPos.x/static_cast<float>(params.resolution), 	// Set position from the origin (x 3D = x window)
+							   origin.getPosition().y + userPos.z/static_cast<float>(params.resolution));	// Set position from the origin (z 3D = y window)
 
 			// Draw the circle
 			window.draw(origin);
@@ -299,8 +390,14 @@ int main(int argc, char* argv[])
 			// Send the matrix to the shader
 			glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
 
-			// Render the chunks
-			manager.renderChunks(&programID);
+			// Render the clipmap levels around the camera, or the chunks
+			if (clipmap) {
+				clipmap->update(viewController.getPosition());
+				clipmap->render(MVP);
+				manager.uploadChunks();
+			} else {
+				manager.renderChunks(&programID, MVP, glm::vec2(window.getSize().x, window.getSize().y));
+			}
 
 			// Unbind Open GL states
 			glBindVertexArray(0);	// Unbind the VAO
@@ -17,6 +17,19 @@
 # --mode ,                  0                   Noise mode (0 - fractal, 1 - turbulent, 2 - opalescent, 3 - gradient weighting)
 # --max,                    5                   Noise max value
 # --cmap, -c,               1                   set color map (0 - GRAY_SCALE, 1 - GIST_EARTH)
+# --precision, -p,         64                  set noise evaluation precision in bits (32 or 64)
+# --cache-dir,              chunk_cache         set directory of the persistent chunk store ("" to disable)
+# --cache-mb,               64                  set memory budget of the recently dropped chunks in MB (0 to disable)
+# --cache-gl,               ---                 keep the OpenGL buffers of the recently dropped chunks
+# --prefetch-time,          1                   set look-ahead time of the chunk prefetch in seconds (0 to disable)
+# --unload-margin,          1                   set number of chunks kept loaded beyond the view distance (0 to 16)
+# --upload-ms,              4                   set time per frame spent uploading new chunks or clipmap rows in ms (0 for no limit)
+# --multi-draw,             ---                 draw all the chunks with one multi-draw call per frame
+# --no-occlusion,           ---                 draw the chunks hidden behind nearer terrain
+# --lod-pixels,             2                   set the largest screen-space error of the chunk levels of detail in pixels (0 for full resolution)
+# --clipmap,                ---                 draw the terrain with a geometry clipmap instead of the chunks
+# --clipmap-levels,         6                   set the number of nested levels of the geometry clipmap
+# --clipmap-size,           129                 set the points per side of a clipmap level (4k + 1)
 
 # Launch the program
 ./main --size 20 --resolution 0.25 --visibility 1 --width 1280 --height 760 --octaves 8 --freq-start 0.05 --freq-rate 2 --amp-rate 0.5 --mode 0 --max 7 --cmap 1
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "ChunkIndices.hpp"
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+/**
+ * Builds the indices the way Chunk::prepareToRender did before the shared index buffer: one strip per row over the
+ * whole chunk width, drawn with one call per strip. The strips are concatenated here, the vertex stream is the same.
+ */
+std::vector<unsigned int> rowStripIndices(unsigned int n) {
+    std::vector<unsigned int> indices;
+    for (unsigned int i = 0; i < n - 1; i++) {
+        for (unsigned int j = 0; j < n; j++) {
+            indices.push_back(i * n + j);
+            indices.push_back((i + 1) * n + j);
+        }
+    }
+    return indices;
+}
+
+/**
+ * Returns the average cache miss ratio (vertices transformed per triangle) of the row strips. Each strip is a separate
+ * draw call, so the degenerate joins of the concatenated stream must not be counted as triangles.
+ */
+double rowStripACMR(const std::vector<unsigned int>& indices, unsigned int n, unsigned int cacheSize) {
+    size_t triangles = static_cast<size_t>(n - 1) * (n - 1) * 2;
+    return static_cast<double>(stripVertexCacheMisses(indices, cacheSize)) / triangles;
+}
+
+/**
+ * Returns the time in microseconds to build the indices of a chunk with the given builder.
+ */
+template <class F>
+double timeBuild(F build, int repeat) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < repeat; i++)
+        sink += build().size();
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    return std::chrono::duration<double, std::micro>(end - start).count() / repeat;
+}
+
+int main(int argc, char* argv[]) {
+    po::variables_map vm;
+    try {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help,h", "print help")
+            ("chunks", po::value<unsigned int>()->default_value(25), "number of chunks uploaded (25 for a visibility of 2)")
+            ("repeat", po::value<int>()->default_value(20), "number of index builds timed for each layout")
+        ;
+
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+
+    unsigned int chunks = vm["chunks"].as<unsigned int>();
+    int repeat = vm["repeat"].as<int>();
+
+    std::printf("Upload bytes for %u chunks, draw calls per chunk, vertices transformed per triangle (FIFO cache of 16/24/32)\n", chunks);
+    std::printf("%6s %8s %14s %8s %8s %8s %8s %12s\n", "N", "layout", "upload[KB]", "draws", "acmr16", "acmr24", "acmr32", "build[us]");
+    for (unsigned int n : {50u, 100u, 200u, 400u}) {
+        std::vector<unsigned int> rows = rowStripIndices(n);
+        std::vector<unsigned int> banded = bandedStripIndices(n);
+        size_t bandedTriangles = stripTriangleCount(banded);
+
+        // Before: every chunk uploads its own copy of the row strips
+        std::printf("%6u %8s %14.1f %8u %8.3f %8.3f %8.3f %12.1f\n", n, "rows",
+                chunks * rows.size() * sizeof(unsigned int) / 1024.0, n - 1,
+                rowStripACMR(rows, n, 16), rowStripACMR(rows, n, 24), rowStripACMR(rows, n, 32),
+                timeBuild([n] { return rowStripIndices(n); }, repeat));
+
+        // After: one shared buffer per chunk size
+        std::printf("%6u %8s %14.1f %8u %8.3f %8.3f %8.3f %12.1f\n", n, "banded",
+                banded.size() * sizeof(unsigned int) / 1024.0, 1u,
+                static_cast<double>(stripVertexCacheMisses(banded, 16)) / bandedTriangles,
+                static_cast<double>(stripVertexCacheMisses(banded, 24)) / bandedTriangles,
+                static_cast<double>(stripVertexCacheMisses(banded, 32)) / bandedTriangles,
+                timeBuild([n] { return bandedStripIndices(n); }, repeat));
+    }
+    return 0;
+}
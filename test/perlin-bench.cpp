@@ -0,0 +1,131 @@
+#include "Perlin.hpp"
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+/**
+ * Generates one chunk the same way ChunkManager::populateChunk does and returns the elapsed time in milliseconds.
+ */
+double timeChunk(GradientNoise& gn, double originX, double originZ, const po::variables_map& vm) {
+    size_t size = vm["size"].as<size_t>();
+    double resolution = vm["resolution"].as<double>();
+    int mode = vm["mode"].as<int>();
+    int octaves = vm["octaves"].as<int>();
+    double freqStart = vm["freq-start"].as<double>();
+    double freqRate = vm["freq-rate"].as<double>();
+    double ampRate = vm["amp-rate"].as<double>();
+
+    std::vector<glm::vec3> heightMap(size * size, glm::vec3(0, 0, 0));
+    for (size_t row = 0; row < size; row++) {
+        for (size_t col = 0; col < size; col++) {
+            heightMap[row * size + col].x = originX + resolution * row;
+            heightMap[row * size + col].z = originZ + resolution * col;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<GradientNoise::GradientTile> tiles;
+    gn.buildOctaveTiles(tiles, heightMap.front().x, heightMap.front().z, heightMap.back().x, heightMap.back().z,
+            mode, octaves, freqStart, freqRate);
+    std::vector<float> xs(size), zs(size), heights(size);
+    for (size_t col = 0; col < size; col++) {
+        zs[col] = heightMap[col].z;
+    }
+    for (size_t row = 0; row < size; row++) {
+        std::fill(xs.begin(), xs.end(), heightMap[row * size].x);
+        gn.fractalPerlin2DRow(xs.data(), zs.data(), heights.data(), size, tiles, 5, mode, freqStart, freqRate, ampRate);
+        for (size_t col = 0; col < size; col++) {
+            heightMap[row * size + col].y = heights[col];
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+ * Returns the average time in nanoseconds to select one gradient with the previous LFSR scheme around lattice position (x, x).
+ */
+double timeLegacyGradient(uint32_t seed, int x) {
+    const int samples = 64;
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+        uint32_t perm = lfsr(seed + x + i, abs(x + i));
+        sink = lfsr(perm + x, abs(x)) % 8;
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+/**
+ * Returns the average time in nanoseconds to select one gradient with latticeHash around lattice position (x, x).
+ */
+double timeHashGradient(uint32_t seed, int x) {
+    const int samples = 4096;
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+        sink = latticeHash(seed, x + i, x) % 8;
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+int main(int argc, char* argv[]) {
+    po::variables_map vm;
+    try {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help,h", "print help")
+            ("size,s", po::value<size_t>()->default_value(200), "set N, the number of points per chunk side")
+            ("resolution,r", po::value<double>()->default_value(0.25), "set the distance between points")
+            ("repeat", po::value<int>()->default_value(5), "number of chunks generated at each distance")
+            ("octaves,o", po::value<int>()->default_value(8), "set number of octaves for fractal perlin noise")
+            ("seed", po::value<uint32_t>()->default_value(1234), "set seed for perlin noise")
+            ("freq-start", po::value<double>()->default_value(0.05), "set starting frequency for fractal perlin noise")
+            ("freq-rate", po::value<double>()->default_value(2), "set frequency rate for fractal perlin noise")
+            ("amp-rate", po::value<double>()->default_value(0.5), "set amplitude decay rate for fractal perlin noise")
+            ("mode,m", po::value<int>()->default_value(0), "Noise mode (0 - fractal, 1 - turbulent, 2 - opalescent, 3 - gradient weighting)")
+        ;
+
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+
+    uint32_t seed = vm["seed"].as<uint32_t>();
+    int repeat = vm["repeat"].as<int>();
+    GradientNoise gn(seed);
+    std::printf("Noise kernel: %s\n", simdLevelName(gn.simdLevel()));
+
+    // Highest octave frequency: lattice coordinates scale with it
+    double maxFreq = vm["freq-start"].as<double>();
+    for (int k = 1; k < vm["octaves"].as<int>(); k++)
+        maxFreq *= vm["freq-rate"].as<double>();
+
+    std::printf("%12s %14s %16s %18s %16s\n", "distance[m]", "lattice coord", "chunk time[ms]", "lfsr gradient[ns]", "hash gradient[ns]");
+    for (double distance : {0.0, 1e2, 1e3, 1e4, 1e5}) {
+        double total = 0;
+        for (int i = 0; i < repeat; i++)
+            total += timeChunk(gn, distance, distance, vm);
+
+        int coord = static_cast<int>(distance * maxFreq);
+        std::printf("%12.0f %14d %16.3f %18.1f %16.1f\n", distance, coord, total / repeat,
+                timeLegacyGradient(seed, coord), timeHashGradient(seed, coord));
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "Perlin.hpp"
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+/**
+ * Deviation of the float kernel against the double kernel over a set of chunks.
+ */
+struct Deviation {
+    double max = 0;         // Largest absolute difference
+    double sumSquares = 0;  // Sum of squared differences
+    size_t samples = 0;     // Number of compared samples
+};
+
+/**
+ * Generates one chunk at (originX, originZ) with both kernels, the same way ChunkManager::populateChunk does, and
+ * accumulates the differences into dev.
+ */
+void compareChunk(GradientNoise& gn, NoiseRowKernel floatKernel, NoiseRowKernel doubleKernel,
+        double originX, double originZ, const po::variables_map& vm, int mode, Deviation& dev) {
+    size_t size = vm["size"].as<size_t>();
+    double resolution = vm["resolution"].as<double>();
+    int octaves = vm["octaves"].as<int>();
+    double max = vm["max"].as<double>();
+    double freqStart = vm["freq-start"].as<double>();
+    double freqRate = vm["freq-rate"].as<double>();
+    double ampRate = vm["amp-rate"].as<double>();
+
+    std::vector<GradientNoise::GradientTile> tiles;
+    gn.buildOctaveTiles(tiles, originX, originZ, originX + resolution * (size - 1), originZ + resolution * (size - 1),
+            mode, octaves, freqStart, freqRate);
+    std::vector<float> xs(size), zs(size), heightsFloat(size), heightsDouble(size);
+    for (size_t col = 0; col < size; col++) {
+        zs[col] = originZ + resolution * col;
+    }
+    for (size_t row = 0; row < size; row++) {
+        std::fill(xs.begin(), xs.end(), static_cast<float>(originX + resolution * row));
+        gn.fractalPerlin2DRow(floatKernel, xs.data(), zs.data(), heightsFloat.data(), size, tiles, max,
+                freqStart, freqRate, ampRate);
+        gn.fractalPerlin2DRow(doubleKernel, xs.data(), zs.data(), heightsDouble.data(), size, tiles, max,
+                freqStart, freqRate, ampRate);
+        for (size_t col = 0; col < size; col++) {
+            double diff = std::fabs(static_cast<double>(heightsFloat[col]) - heightsDouble[col]);
+            dev.max = std::max(dev.max, diff);
+            dev.sumSquares += diff * diff;
+            dev.samples++;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    po::variables_map vm;
+    try {
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("help,h", "print help")
+            ("size,s", po::value<size_t>()->default_value(100), "set N, the number of points per chunk side")
+            ("resolution,r", po::value<double>()->default_value(0.25), "set the distance between points")
+            ("chunks,c", po::value<int>()->default_value(3), "number of chunks per side of the region compared at each distance")
+            ("octaves,o", po::value<int>()->default_value(8), "set number of octaves for fractal perlin noise")
+            ("seed", po::value<uint32_t>()->default_value(1234), "set seed for perlin noise")
+            ("freq-start", po::value<double>()->default_value(0.05), "set starting frequency for fractal perlin noise")
+            ("freq-rate", po::value<double>()->default_value(2), "set frequency rate for fractal perlin noise")
+            ("amp-rate", po::value<double>()->default_value(0.5), "set amplitude decay rate for fractal perlin noise")
+            ("max", po::value<double>()->default_value(5), "Noise max value")
+        ;
+
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+
+    GradientNoise gn(vm["seed"].as<uint32_t>());
+    int octaves = vm["octaves"].as<int>();
+    int chunks = vm["chunks"].as<int>();
+    double chunkSize = vm["size"].as<size_t>() * vm["resolution"].as<double>();
+    std::printf("Noise kernel: %s\n", simdLevelName(gn.simdLevel()));
+
+    // Compare a square region of chunks around each distance, for every noise mode
+    std::printf("%6s %12s %10s %14s %14s %14s\n", "mode", "distance[m]", "samples", "max dev", "rms dev", "max dev/max");
+    for (int mode = 0; mode <= 2; mode++) {
+        NoiseRowKernel floatKernel = gn.rowKernel<float>(mode, octaves);
+        NoiseRowKernel doubleKernel = gn.rowKernel<double>(mode, octaves);
+        for (double distance : {0.0, 1e3, 1e4, 1e5}) {
+            Deviation dev;
+            for (int i = 0; i < chunks; i++) {
+                for (int j = 0; j < chunks; j++) {
+                    compareChunk(gn, floatKernel, doubleKernel, distance + i * chunkSize, distance + j * chunkSize,
+                            vm, mode, dev);
+                }
+            }
+            std::printf("%6d %12.0f %10zu %14.3e %14.3e %14.3e\n", mode, distance, dev.samples, dev.max,
+                    std::sqrt(dev.sumSquares / dev.samples), dev.max / vm["max"].as<double>());
+        }
+    }
+    return 0;
+}